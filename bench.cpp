@@ -0,0 +1,1415 @@
+/* Copyright Fedor Indutny. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Throughput of execute() per workload and parsing policy. A workload is
+ * a list of streams, each one connection that a freshly reset parser is
+ * fed in reads of READ_SIZE bytes (the whole stream by default) followed
+ * by EOF; "-r random" reads 1 to 1460 bytes at a time from a seeded
+ * generator. Every workload is repeated for at least SECONDS (0.5 by
+ * default) after a warm-up round that counts messages and errors. MB/s is
+ * of the bytes execute() scans: the 1 MB body of large_body goes to
+ * on_body in one call without being looked at, so it is left out, and the
+ * rate including the body is reported apart as "body skip" (skip_mb_per_s
+ * in JSON); it only shows that the cost of a message does not grow with
+ * its body. corpus_requests and corpus_responses are the messages of the
+ * test suite (corpus.hpp), one stream each.
+ *
+ * The variants are the policies of execute(): "switch" and "threaded"
+ * parse any stream, "request_only" and "response_only" are compiled for
+ * one type of message and only run on workloads of that type, where they
+ * save the checks for the other one: 5 to 15% less time for short_get,
+ * pipelined, corpus_responses and adv_1byte_chunks, and about 30% for
+ * adv_long_url, with GCC 12 on x86-64. "static_callbacks" is "switch" with
+ * the callbacks as static member functions (struct static_callbacks),
+ * which execute() calls directly instead of through std::function, so
+ * its difference from "switch" is what std::function costs. bench is
+ * compiled with HTTP_PARSER_HEADER_ONLY for it.
+ *
+ * The adv_ workloads are made for the slow paths rather than to look like
+ * real traffic: a long quoted value full of backslash escapes, thousands
+ * of tiny headers, a value folded over thousands of lines, 1-byte chunks,
+ * chunk extensions close to HTTP_MAX_CHUNK_EXTENSION_SIZE and an absolute
+ * URL with an IPv6 host and a long path, query and fragment. Since
+ * execute() takes no userinfo in the request line, adv_parse_url times
+ * http_parser_parse_url() alone on the same URL with a long userinfo. As
+ * the input is the attacker's to choose, a plain run ends with the worst
+ * cycles per byte (ns per byte without counters) of all of them.
+ *
+ * Then every message of some more rounds is timed from on_message_begin
+ * to on_message_complete, with the TSC where there is one, into a
+ * log-bucketed histogram (see struct histogram) for p50 to p99.9 and max.
+ *
+ *   ./bench [-t seconds] [-r read_size] [-w workload] [-v variant] [-o json]
+ *           [file...]
+ *   ./bench -s [-t seconds] [-w workload] [-v variant] [file...]
+ *   ./bench -j threads [-p] [-t seconds] [-r read_size] [-w workload]
+ *           [-v variant] [file...]
+ *   ./bench -c base.json new.json [-T percent]
+ *   ./bench infinite
+ *
+ * -s sweeps the read sizes of split_sizes[] for every workload and reports
+ * the slowdown against parsing each stream in one buffer, and the cost of
+ * every additional execute() call, i.e. of resuming at a read boundary.
+ *
+ * -j runs every workload on 1, 2, 4, ... and finally THREADS threads at
+ * once, each with its own parser and its own copy of the input, and
+ * reports the aggregate throughput, the slowest and fastest thread and
+ * the scaling against one thread. With -p thread i is pinned to the i-th
+ * CPU the process may run on.
+ *
+ * Given capture FILEs, each of them is a workload instead of the built-in
+ * ones, and the streams that fail to parse are reported by error. A
+ * capture file is mapped into memory and holds either one raw connection,
+ * parsed as HTTP_BOTH (e.g. corpus/), or, if its first line is
+ * "http-streams 1", any number of connections:
+ *
+ *   http-streams 1
+ *   # comment
+ *   stream request 37
+ *   GET / HTTP/1.1\r\nHost: example.com\r\n\r\n
+ *   stream response 38
+ *   HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n
+ *
+ * "stream TYPE LENGTH" is followed by exactly LENGTH bytes of the
+ * connection. TYPE is request, response or both. Lines end with LF;
+ * empty lines and lines starting with '#' between streams are ignored.
+ *
+ * On Linux, the timed rounds are also measured with hardware counters
+ * (perf_event_open(2)) for cycles and instructions per byte, IPC, branch
+ * misses and L1-i misses. Where counters are unavailable, e.g. in a
+ * container or with perf_event_paranoid > 2, only times are reported.
+ *
+ * -o FILE also writes the results of a plain run to FILE as JSON, along
+ * with the compiler, its flags and the CPU model. Every result is one line
+ * of the file. -c compares two such files and exits with 1 if the ns/msg
+ * of any workload and variant in both grew by more than PERCENT (5 by
+ * default); "make bench-compare" runs it.
+ *
+ * "infinite" parses the browser POST forever, for use under a profiler.
+ */
+
+#include "http_parser.hpp"
+#include "corpus.hpp"
+#include "test_helpers.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+#endif
+
+#ifdef __linux__
+# include <sched.h>
+# include <pthread.h>
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char data[] =
+    "POST /joyent/http-parser HTTP/1.1\r\n"
+    "Host: github.com\r\n"
+    "DNT: 1\r\n"
+    "Accept-Encoding: gzip, deflate, sdch\r\n"
+    "Accept-Language: ru-RU,ru;q=0.8,en-US;q=0.6,en;q=0.4\r\n"
+    "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_10_1) "
+        "AppleWebKit/537.36 (KHTML, like Gecko) "
+        "Chrome/39.0.2171.65 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,"
+        "image/webp,*/*;q=0.8\r\n"
+    "Referer: https://github.com/joyent/http-parser\r\n"
+    "Connection: keep-alive\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "Cache-Control: max-age=0\r\n\r\nb\r\nhello world\r\n0\r\n\r\n";
+
+static const char short_get[] =
+    "GET /favicon.ico HTTP/1.1\r\n"
+    "Host: 0.0.0.0=5000\r\n"
+    "\r\n";
+
+/* One connection */
+struct stream {
+  http_parser::http_parser_type type;
+  const char *data;
+  size_t len;
+};
+
+struct workload {
+  std::string name;
+  std::vector<stream> streams;
+  size_t bytes;             /* of all streams */
+  unsigned long messages;   /* expected per round; 0 if unknown */
+  bool capture;
+  size_t skipped = 0;       /* of BYTES, body passed to on_body unscanned */
+};
+
+struct variant {
+  const char *name;
+  /* Streams it can parse; the others are skipped */
+  http_parser::http_parser_type type;
+  size_t (*execute)(http_parser& parser,
+                    const http_parser::parser_settings& settings,
+                    const char *data, size_t len);
+};
+
+enum counter
+  { CYCLES
+  , INSTRUCTIONS
+  , BRANCHES
+  , BRANCH_MISSES
+  , L1I_MISSES
+  , NUM_COUNTERS
+  };
+
+/* Log-linear histogram of nanoseconds in the manner of HdrHistogram:
+ * values below 2^SUB_BITS are exact, larger ones fall into one of
+ * 2^SUB_BITS buckets per power of two, i.e. with an error below 1.6%.
+ */
+struct histogram {
+  static const int sub_bits = 6;
+  static const int max_exponent = 40;  /* about 18 minutes */
+
+  std::vector<uint64_t> counts;
+  uint64_t total;
+  uint64_t max;
+
+  histogram()
+    : counts((max_exponent - sub_bits + 2) << sub_bits), total(0), max(0) {}
+
+  static size_t index(uint64_t v) {
+    int e;
+
+    if (v < (1u << sub_bits)) {
+      return v;
+    }
+    e = 63 - __builtin_clzll(v);
+    return ((e - sub_bits + 1) << sub_bits) + (v >> (e - sub_bits)) - (1u << sub_bits);
+  }
+
+  /* Largest value of bucket I */
+  static uint64_t value(size_t i) {
+    int shift;
+
+    if (i < (1u << sub_bits)) {
+      return i;
+    }
+    shift = (i >> sub_bits) - 1;
+    return (((uint64_t) (i & ((1u << sub_bits) - 1)) + (1u << sub_bits) + 1) << shift) - 1;
+  }
+
+  void record(uint64_t v) {
+    if (v >= (2ull << max_exponent)) {
+      v = (2ull << max_exponent) - 1;
+    }
+    counts[index(v)]++;
+    total++;
+    if (v > max) {
+      max = v;
+    }
+  }
+
+  uint64_t percentile(double p) const {
+    uint64_t rank = (uint64_t) (p / 100 * total);
+    uint64_t seen = 0;
+    size_t i;
+
+    for (i = 0; i < counts.size(); i++) {
+      seen += counts[i];
+      if (seen > rank) {
+        return std::min(value(i), max);
+      }
+    }
+    return max;
+  }
+};
+
+struct result {
+  unsigned long rounds;
+  double elapsed;
+  unsigned long messages;   /* per round */
+  unsigned long reads;      /* execute() calls per round, EOF not counted */
+  unsigned long errors;     /* streams that failed to parse, per round */
+  std::map<std::string, unsigned long> error_names;
+  histogram latency;              /* ns per message */
+  double counts[NUM_COUNTERS];    /* of the timed rounds; < 0 if unknown */
+};
+
+static const size_t latency_samples = 10000;
+
+/* Read size that picks a new random size for every read */
+static const size_t random_reads = (size_t) -1;
+static const size_t max_random_read = 1460;
+
+/* Read sizes of -s; 0 is the whole stream */
+static const size_t split_sizes[] = { 0, 1, 2, 7, 64, 536, 1460, random_reads };
+
+/* Backs the streams of the built-in workloads */
+static std::deque<std::string> buffers;
+
+/* Per thread, for -j */
+static thread_local unsigned long messages;
+static thread_local unsigned long reads;
+static thread_local uint32_t random_state;
+static thread_local uint64_t message_start;
+static thread_local histogram *latencies;
+static double ns_per_tick;
+
+static int on_info(http_parser&) {
+  return 0;
+}
+
+static int on_data(http_parser&, const char *, size_t) {
+  return 0;
+}
+
+static int on_message_complete(http_parser&) {
+  messages++;
+  return 0;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int counter_fds[NUM_COUNTERS] = { -1, -1, -1, -1, -1 };
+
+/* Opens the counters of this thread, user space only; counters the CPU or
+ * the kernel does not provide stay closed. False if there are none.
+ */
+static bool open_counters(void) {
+#ifdef __linux__
+  static const struct { uint32_t type; uint64_t config; } events[NUM_COUNTERS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1I |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+  };
+  struct perf_event_attr attr;
+  int i, err = 0;
+
+  for (i = 0; i < NUM_COUNTERS; i++) {
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[i].type;
+    attr.config = events[i].config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    counter_fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (counter_fds[i] < 0 && err == 0) {
+      err = errno;
+    }
+  }
+
+  if (counter_fds[CYCLES] >= 0) {
+    return true;
+  }
+  fprintf(stderr, "hardware counters unavailable (%s), timing only\n",
+          strerror(err));
+#endif
+  return false;
+}
+
+/* VALUE is < 0 if the counter is closed */
+struct counter_reading {
+  double value;
+  double enabled;   /* ns */
+  double running;   /* ns, less than ENABLED if counters were multiplexed */
+};
+
+static void read_counters(counter_reading readings[NUM_COUNTERS]) {
+  uint64_t buf[3];
+  int i;
+
+  for (i = 0; i < NUM_COUNTERS; i++) {
+    readings[i] = { -1, 0, 0 };
+    if (counter_fds[i] >= 0 && read(counter_fds[i], buf, sizeof(buf)) == sizeof(buf)) {
+      readings[i] = { (double) buf[0], (double) buf[1], (double) buf[2] };
+    }
+  }
+}
+
+/* Fills R.counts with the scaled difference of two readings */
+static void count(result& r, const counter_reading before[NUM_COUNTERS],
+                  const counter_reading after[NUM_COUNTERS]) {
+  double running;
+  int i;
+
+  for (i = 0; i < NUM_COUNTERS; i++) {
+    running = after[i].running - before[i].running;
+    r.counts[i] = -1;
+    if (before[i].value >= 0 && after[i].value >= 0 && running > 0) {
+      r.counts[i] = (after[i].value - before[i].value) *
+                    (after[i].enabled - before[i].enabled) / running;
+    }
+  }
+}
+
+static size_t random_read_size(void) {
+  return test_helpers::next_random(random_state) % max_random_read + 1;
+}
+
+/* Time stamp for the latency of one message */
+static inline uint64_t ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+/* Measures ns_per_tick against the monotonic clock over 50 ms */
+static void calibrate_ticks(void) {
+  double start = now(), end;
+  uint64_t t = ticks();
+
+  do {
+    end = now();
+  } while (end - start < 0.05);
+
+  ns_per_tick = (end - start) * 1e9 / (ticks() - t);
+}
+
+static int on_message_begin_timed(http_parser&) {
+  message_start = ticks();
+  return 0;
+}
+
+static int on_message_complete_timed(http_parser&) {
+  latencies->record((uint64_t) ((ticks() - message_start) * ns_per_tick));
+  messages++;
+  return 0;
+}
+
+/* The callbacks of main()'s settings, as static member functions */
+struct static_callbacks {
+  static int on_message_begin(http_parser& p) { return on_info(p); }
+  static int on_url(http_parser& p, const char *at, size_t length) {
+    return on_data(p, at, length);
+  }
+  static int on_reason(http_parser& p, const char *at, size_t length) {
+    return on_data(p, at, length);
+  }
+  static int on_header_field(http_parser& p, const char *at, size_t length) {
+    return on_data(p, at, length);
+  }
+  static int on_header_value(http_parser& p, const char *at, size_t length) {
+    return on_data(p, at, length);
+  }
+  static int on_headers_complete(http_parser& p, const char *at, size_t length) {
+    return on_data(p, at, length);
+  }
+  static int on_body(http_parser& p, const char *at, size_t length) {
+    return on_data(p, at, length);
+  }
+  static int on_message_complete(http_parser& p) { return ::on_message_complete(p); }
+  static int on_chunk_header(http_parser& p) { return on_info(p); }
+  static int on_chunk_complete(http_parser& p) { return on_info(p); }
+  static constexpr int (*on_chunk_extension)(http_parser&, const char *, size_t) = nullptr;
+  static constexpr int (*on_trailer_field)(http_parser&, const char *, size_t) = nullptr;
+  static constexpr int (*on_trailer_value)(http_parser&, const char *, size_t) = nullptr;
+  static constexpr int (*on_trailers_complete)(http_parser&) = nullptr;
+};
+
+/* ... and with the callbacks of the timed rounds of run() */
+struct static_callbacks_timed : static_callbacks {
+  static int on_message_begin(http_parser& p) { return on_message_begin_timed(p); }
+  static int on_message_complete(http_parser& p) { return on_message_complete_timed(p); }
+};
+
+/* Set by run() for its timed rounds */
+static thread_local bool timed_round;
+
+template <class Policy>
+static size_t execute(http_parser& parser,
+                      const http_parser::parser_settings& settings,
+                      const char *data, size_t len) {
+  return parser.execute<Policy>(settings, data, len);
+}
+
+/* Ignores SETTINGS, which are main()'s or those of the timed rounds */
+template <class Policy>
+static size_t execute_static(http_parser& parser,
+                             const http_parser::parser_settings&,
+                             const char *data, size_t len) {
+  if (timed_round) {
+    return parser.execute<Policy>(static_callbacks_timed(), data, len);
+  }
+  return parser.execute<Policy>(static_callbacks(), data, len);
+}
+
+static const variant variants[] = {
+  { "switch", http_parser::HTTP_BOTH, execute<http_parser_default_policy> },
+  { "threaded", http_parser::HTTP_BOTH, execute<http_parser_threaded> },
+  { "request_only", http_parser::HTTP_REQUEST, execute<http_parser_request_only> },
+  { "response_only", http_parser::HTTP_RESPONSE, execute<http_parser_response_only> },
+  { "static_callbacks", http_parser::HTTP_BOTH, execute_static<http_parser_default_policy> },
+};
+
+/* Stands for http_parser_parse_url() in the results of adv_parse_url */
+static const variant parse_url_variant = { "parse_url", http_parser::HTTP_BOTH, NULL };
+
+/* V can parse every stream of W */
+static bool can_parse(const variant& v, const workload& w) {
+  for (const stream& s : w.streams) {
+    if (v.type != http_parser::HTTP_BOTH && s.type != v.type) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* What MB/s is reported for: the bytes of W that execute() looks at */
+static size_t scanned_bytes(const workload& w) {
+  return w.bytes - w.skipped;
+}
+
+static void add_workload(std::vector<workload>& w, const char *name,
+                         http_parser::http_parser_type type,
+                         const std::string& buf, unsigned long messages) {
+  buffers.push_back(buf);
+  const std::string& b = buffers.back();
+  w.push_back({ name, { { type, b.data(), b.size() } }, b.size(), messages, false });
+}
+
+/* One stream per message of MSGS, which are parsed in place */
+static void add_corpus(std::vector<workload>& w, const char *name,
+                       const corpus::message *msgs, int n) {
+  workload c = { name, {}, 0, (unsigned long) n, false };
+  int i;
+
+  for (i = 0; i < n; i++) {
+    c.streams.push_back({ msgs[i].type, msgs[i].raw, strlen(msgs[i].raw) });
+    c.bytes += strlen(msgs[i].raw);
+  }
+  w.push_back(c);
+}
+
+/* Absolute URL with an IPv6 host and a long path, query and fragment.
+ * execute() takes no userinfo in the request line, so only the URL for
+ * http_parser_parse_url() has one.
+ */
+static std::string long_url(bool userinfo) {
+  std::string s = "http://";
+  int i;
+
+  if (userinfo) {
+    for (i = 0; i < 200; i++) {
+      s += "user%20name:p%40ss;";
+    }
+    s += "@";
+  }
+  s += "[2001:db8:85a3:8d3:1319:8a2e:370:7348]:65535";
+  for (i = 0; i < 6000; i++) {
+    s += "/a%2F=b";
+  }
+  s += "?q=";
+  for (i = 0; i < 2000; i++) {
+    s += "k%3D&v=";
+  }
+  return s + "#fragment";
+}
+
+static std::vector<workload> make_workloads(void) {
+  std::vector<workload> w;
+  std::string s;
+  int i, j;
+
+  add_workload(w, "short_get", http_parser::HTTP_REQUEST, short_get, 1);
+  add_workload(w, "browser_post", http_parser::HTTP_REQUEST, data, 1);
+
+  s = "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/json\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n";
+  for (i = 0; i < 16; i++) {
+    s += "100\r\n";
+    s += std::string(256, 'a' + i);
+    s += "\r\n";
+  }
+  s += "0\r\n\r\n";
+  add_workload(w, "chunked_response", http_parser::HTTP_RESPONSE, s, 1);
+
+  s.clear();
+  for (i = 0; i < 64; i++) {
+    s += short_get;
+  }
+  add_workload(w, "pipelined", http_parser::HTTP_REQUEST, s, 64);
+
+  s = "POST /upload HTTP/1.1\r\n"
+      "Host: 0.0.0.0=5000\r\n"
+      "Content-Type: application/octet-stream\r\n"
+      "Content-Length: 1048576\r\n"
+      "\r\n";
+  s += std::string(1048576, 'x');
+  add_workload(w, "large_body", http_parser::HTTP_REQUEST, s, 1);
+  w.back().skipped = 1048576;
+
+  add_corpus(w, "corpus_requests", corpus::requests, corpus::NUM_REQUESTS);
+  add_corpus(w, "corpus_responses", corpus::responses, corpus::NUM_RESPONSES);
+
+  /* The adversarial workloads: the slow paths of the state machine, each
+   * as large as the limits of http_parser.hpp let it be.
+   */
+  s = "GET / HTTP/1.1\r\n"
+      "X-Quoted: \"";
+  for (i = 0; i < 12000; i++) {
+    s += "a\\\"\\\\";
+  }
+  s += "\"\r\n\r\n";
+  add_workload(w, "adv_quoted_value", http_parser::HTTP_REQUEST, s, 1);
+
+  s = "GET / HTTP/1.1\r\n";
+  for (i = 0; i < 15000; i++) {
+    s += "a:b\r\n";
+  }
+  s += "\r\n";
+  add_workload(w, "adv_tiny_headers", http_parser::HTTP_REQUEST, s, 1);
+
+  s = "GET / HTTP/1.1\r\n"
+      "X-Folded: a";
+  for (i = 0; i < 15000; i++) {
+    s += "\r\n b";
+  }
+  s += "\r\n\r\n";
+  add_workload(w, "adv_folded_value", http_parser::HTTP_REQUEST, s, 1);
+
+  s = "HTTP/1.1 200 OK\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n";
+  for (i = 0; i < 20000; i++) {
+    s += "1\r\nx\r\n";
+  }
+  s += "0\r\n\r\n";
+  add_workload(w, "adv_1byte_chunks", http_parser::HTTP_RESPONSE, s, 1);
+
+  s = "HTTP/1.1 200 OK\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n";
+  for (i = 0; i < 8; i++) {
+    s += "4";
+    for (j = 0; j < 750; j++) {
+      s += ";name=value;q=\"a\\\"b\"";
+    }
+    s += "\r\nbody\r\n";
+  }
+  s += "0\r\n\r\n";
+  add_workload(w, "adv_chunk_extensions", http_parser::HTTP_RESPONSE, s, 1);
+
+  s = "GET " + long_url(false) + " HTTP/1.1\r\n"
+      "\r\n";
+  add_workload(w, "adv_long_url", http_parser::HTTP_REQUEST, s, 1);
+
+  return w;
+}
+
+/* Maps capture file NAME (see the top of this file) and appends it to W */
+static bool load_capture(const char *name, std::vector<workload>& w) {
+  static const char magic[] = "http-streams 1\n";
+  struct stat st;
+  const char *map, *p, *end, *eol;
+  char line[128], type[16];
+  unsigned long long len;
+  int fd;
+
+  fd = open(name, O_RDONLY);
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    perror(name);
+    return false;
+  }
+
+  map = "";
+  if (st.st_size > 0) {
+    map = (const char *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      perror(name);
+      close(fd);
+      return false;
+    }
+  }
+  close(fd);
+
+  const char *base = strrchr(name, '/');
+  w.push_back({ base != NULL ? base + 1 : name, {}, (size_t) st.st_size, 0, true });
+  workload& c = w.back();
+
+  p = map;
+  end = map + st.st_size;
+
+  if ((size_t) st.st_size < sizeof(magic) - 1 ||
+      memcmp(p, magic, sizeof(magic) - 1) != 0) {
+    c.streams.push_back({ http_parser::HTTP_BOTH, p, (size_t) st.st_size });
+    return true;
+  }
+
+  c.bytes = 0;
+  p += sizeof(magic) - 1;
+  while (p < end) {
+    eol = (const char *) memchr(p, '\n', end - p);
+    if (eol == NULL) {
+      eol = end;
+    }
+
+    if (p == eol || *p == '#') {
+      p = eol + 1;
+      continue;
+    }
+
+    snprintf(line, sizeof(line), "%.*s", (int) std::min<size_t>(eol - p, sizeof(line) - 1), p);
+    if (sscanf(line, "stream %15s %llu", type, &len) != 2 ||
+        eol == end || len > (unsigned long long) (end - eol - 1)) {
+      fprintf(stderr, "%s: bad stream at offset %lu: %s\n", name,
+              (unsigned long) (p - map), line);
+      return false;
+    }
+
+    http_parser::http_parser_type t;
+    if (strcmp(type, "request") == 0) {
+      t = http_parser::HTTP_REQUEST;
+    } else if (strcmp(type, "response") == 0) {
+      t = http_parser::HTTP_RESPONSE;
+    } else if (strcmp(type, "both") == 0) {
+      t = http_parser::HTTP_BOTH;
+    } else {
+      fprintf(stderr, "%s: unknown stream type %s at offset %lu\n", name,
+              type, (unsigned long) (p - map));
+      return false;
+    }
+
+    c.streams.push_back({ t, eol + 1, (size_t) len });
+    c.bytes += len;
+    p = eol + 1 + len;
+  }
+
+  return true;
+}
+
+/* Feeds S to PARSER in reads of READ_SIZE bytes and then EOF; false if
+ * it does not parse. The rest of a stream that upgrades the connection is
+ * not HTTP and is skipped.
+ */
+static bool parse_stream(http_parser& parser, const variant& v,
+                         const http_parser::parser_settings& settings,
+                         const stream& s, size_t read_size) {
+  const char *data = s.data;
+  size_t left = s.len;
+  size_t len;
+
+  parser.reset(s.type);
+
+  while (left > 0) {
+    len = read_size == random_reads ? random_read_size() : read_size;
+    if (len == 0 || len > left) {
+      len = left;
+    }
+    reads++;
+    if (v.execute(parser, settings, data, len) != len) {
+      return parser.has_upgrade();
+    }
+    data += len;
+    left -= len;
+  }
+
+  /* 1 if EOF came in the middle of a message */
+  return v.execute(parser, settings, NULL, 0) == 0;
+}
+
+/* One pass over W; counts the streams that fail in R if given */
+static void parse_round(const workload& w, const variant& v,
+                        const http_parser::parser_settings& settings,
+                        size_t read_size, result *r) {
+  http_parser parser(http_parser::HTTP_BOTH);
+
+  for (const stream& s : w.streams) {
+    if (!parse_stream(parser, v, settings, s, read_size) && r != NULL) {
+      r->errors++;
+      r->error_names[parser.get_errno().name()]++;
+    }
+  }
+}
+
+/* Parses W in a loop for at least SECONDS after a warm-up round that
+ * counts messages and errors. If TIMED, every message of some more rounds
+ * (at least LATENCY_SAMPLES messages) is timed.
+ */
+static void run(const workload& w, const variant& v,
+                const http_parser::parser_settings& settings,
+                double seconds, size_t read_size, bool timed, result& r) {
+  unsigned long batch = 1, i;
+  double start;
+  counter_reading before[NUM_COUNTERS], after[NUM_COUNTERS];
+
+  r = result();
+
+  random_state = 2463534242u;
+  messages = 0;
+  reads = 0;
+  parse_round(w, v, settings, read_size, &r);
+  r.messages = messages;
+  r.reads = reads;
+
+  read_counters(before);
+  while (r.elapsed < seconds) {
+    start = now();
+    for (i = 0; i < batch; i++) {
+      parse_round(w, v, settings, read_size, NULL);
+    }
+    r.elapsed += now() - start;
+    r.rounds += batch;
+    if (batch < (1ul << 20)) {
+      batch *= 2;
+    }
+  }
+  read_counters(after);
+  count(r, before, after);
+
+  if (timed) {
+    http_parser::parser_settings timed_settings = settings;
+    timed_settings.on_message_begin = on_message_begin_timed;
+    timed_settings.on_message_complete = on_message_complete_timed;
+
+    latencies = &r.latency;
+    timed_round = true;
+    while (r.messages > 0 && r.latency.total < latency_samples) {
+      parse_round(w, v, timed_settings, read_size, NULL);
+    }
+    timed_round = false;
+  }
+}
+
+/* Like run(), for http_parser_parse_url() of URL; every call is a message */
+static void run_parse_url(const std::string& url, double seconds, result& r) {
+  struct http_parser_url u;
+  unsigned long batch = 1, i;
+  double start;
+  counter_reading before[NUM_COUNTERS], after[NUM_COUNTERS];
+
+  r = result();
+  r.messages = 1;
+  if (http_parser_parse_url(url.data(), url.size(), 0, &u) != 0) {
+    r.errors = 1;
+    r.error_names["parse_url"]++;
+    return;
+  }
+
+  read_counters(before);
+  while (r.elapsed < seconds) {
+    start = now();
+    for (i = 0; i < batch; i++) {
+      http_parser_parse_url(url.data(), url.size(), 0, &u);
+    }
+    r.elapsed += now() - start;
+    r.rounds += batch;
+    if (batch < (1ul << 20)) {
+      batch *= 2;
+    }
+  }
+  read_counters(after);
+  count(r, before, after);
+}
+
+/* Counter line of R, if any */
+static void report_counters(const workload& w, const result& r) {
+  double bytes = (double) r.rounds * w.bytes;
+  double msgs = (double) r.rounds * r.messages;
+  const double *c = r.counts;
+
+  if (c[CYCLES] < 0) {
+    return;
+  }
+
+  printf("%-41s %.2f cycles/B", "", c[CYCLES] / bytes);
+  if (c[INSTRUCTIONS] >= 0) {
+    printf(" %.2f insns/B IPC %.2f", c[INSTRUCTIONS] / bytes,
+           c[INSTRUCTIONS] / c[CYCLES]);
+  }
+  if (c[BRANCHES] > 0 && c[BRANCH_MISSES] >= 0) {
+    printf(" branch misses %.2f%%", 100 * c[BRANCH_MISSES] / c[BRANCHES]);
+  }
+  if (c[L1I_MISSES] >= 0 && msgs > 0) {
+    printf(" L1-i misses %.2f/msg", c[L1I_MISSES] / msgs);
+  }
+  printf("\n");
+}
+
+/* Pins the calling thread to the I-th CPU of the process */
+static void pin_thread(int i) {
+#ifdef __linux__
+  cpu_set_t allowed, one;
+  int cpu, n = 0;
+
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return;
+  }
+  i %= CPU_COUNT(&allowed);
+  for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed) && n++ == i) {
+      CPU_ZERO(&one);
+      CPU_SET(cpu, &one);
+      pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+      return;
+    }
+  }
+#else
+  (void) i;
+#endif
+}
+
+/* Copy of W whose streams point into STORAGE */
+static workload copy_workload(const workload& w, std::string& storage) {
+  workload copy = w;
+  size_t off = 0;
+
+  storage.clear();
+  for (const stream& s : w.streams) {
+    storage.append(s.data, s.len);
+  }
+  for (stream& s : copy.streams) {
+    s.data = storage.data() + off;
+    off += s.len;
+  }
+  return copy;
+}
+
+/* run() on N threads at once; R gets the result of every thread */
+static void run_threads(const workload& w, const variant& v,
+                        const http_parser::parser_settings& settings,
+                        double seconds, size_t read_size, int n, bool pin,
+                        std::vector<result>& r) {
+  std::vector<std::thread> threads;
+  std::atomic<int> ready(0);
+  int i;
+
+  r.assign(n, result());
+
+  for (i = 0; i < n; i++) {
+    threads.emplace_back([&, i] {
+      std::string storage;
+      result own;
+
+      if (pin) {
+        pin_thread(i);
+      }
+
+      /* allocated by this thread, so that it is local to its CPU */
+      workload mine = copy_workload(w, storage);
+      http_parser::parser_settings my_settings = settings;
+
+      ready++;
+      while (ready.load() < n) {
+        std::this_thread::yield();
+      }
+
+      run(mine, v, my_settings, seconds, read_size, false, own);
+      r[i] = own;
+    });
+  }
+
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+/* Lines of -j for W and V on 1, 2, 4, ... MAX_THREADS threads */
+static void report_scaling(const workload& w, const variant& v,
+                           const http_parser::parser_settings& settings,
+                           double seconds, size_t read_size,
+                           int max_threads, bool pin) {
+  std::vector<result> r;
+  double single = 0, total, bytes, msgs, slowest, fastest;
+  int n = 1, i;
+
+  for (;;) {
+    run_threads(w, v, settings, seconds, read_size, n, pin, r);
+
+    total = 0;
+    bytes = 0;
+    slowest = 0;
+    fastest = 0;
+    for (i = 0; i < n; i++) {
+      msgs = r[i].rounds * r[i].messages / r[i].elapsed;
+      total += msgs;
+      bytes += r[i].rounds * scanned_bytes(w) / r[i].elapsed;
+      slowest = i == 0 || msgs < slowest ? msgs : slowest;
+      fastest = msgs > fastest ? msgs : fastest;
+    }
+    if (n == 1) {
+      single = total;
+    }
+
+    printf("%-24s %-16s %3d threads %12.0f msg/s %10.2f MB/s"
+           "  per thread %10.0f - %10.0f msg/s  scaling %5.1f%%\n",
+           w.name.c_str(), v.name, n, total, bytes / (1024 * 1024),
+           slowest, fastest, single > 0 ? 100 * total / (single * n) : 0);
+
+    if (n == max_threads) {
+      break;
+    }
+    n = std::min(n * 2, max_threads);
+  }
+}
+
+#ifndef BENCH_FLAGS
+# define BENCH_FLAGS ""
+#endif
+
+#if defined(__clang__)
+# define BENCH_COMPILER "clang " __clang_version__
+#elif defined(__GNUC__)
+# define BENCH_COMPILER "gcc " __VERSION__
+#else
+# define BENCH_COMPILER "unknown"
+#endif
+
+/* S as a JSON string literal */
+static std::string json_string(const std::string& s) {
+  std::string out = "\"";
+  char buf[8];
+
+  for (unsigned char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (c < 0x20) {
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+static std::string cpu_model(void) {
+  char line[256];
+  std::string model = "unknown";
+  FILE *f = fopen("/proc/cpuinfo", "r");
+  char *colon;
+
+  if (f == NULL) {
+    return model;
+  }
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (strncmp(line, "model name", 10) == 0 && (colon = strchr(line, ':')) != NULL) {
+      model = colon + 2;
+      model.erase(model.find_last_not_of("\r\n") + 1);
+      break;
+    }
+  }
+  fclose(f);
+  return model;
+}
+
+/* JSON number, or null for a counter that was not available */
+static std::string json_number(double d) {
+  char buf[32];
+
+  if (d < 0) {
+    return "null";
+  }
+  snprintf(buf, sizeof(buf), "%.4g", d);
+  return buf;
+}
+
+static const char *read_size_name(size_t read_size) {
+  static char buf[32];
+
+  if (read_size == 0) {
+    return "whole";
+  } else if (read_size == random_reads) {
+    return "random";
+  }
+  snprintf(buf, sizeof(buf), "%lu", (unsigned long) read_size);
+  return buf;
+}
+
+/* Line of -s for R, read in READ_SIZE bytes, against WHOLE */
+static void report_split(const workload& w, const variant& v, size_t read_size,
+                         const result& r, const result& whole) {
+  double ns = r.elapsed * 1e9 / r.rounds;
+  double whole_ns = whole.elapsed * 1e9 / whole.rounds;
+
+  printf("%-24s %-16s %-7s %10.1f ns/msg %10.2f MB/s %7.2fx",
+         w.name.c_str(), v.name, read_size_name(read_size),
+         r.messages > 0 ? ns / r.messages : 0,
+         r.rounds * scanned_bytes(w) / r.elapsed / (1024 * 1024), ns / whole_ns);
+  if (r.reads > whole.reads) {
+    printf(" %8.1f ns/extra read", (ns - whole_ns) / (r.reads - whole.reads));
+  }
+  printf("\n");
+  report_counters(w, r);
+}
+
+static void report(const workload& w, const variant& v, const result& r) {
+  double msgs = (double) r.rounds * r.messages;
+
+  printf("%-24s %-16s %10.1f ns/msg %10.2f MB/s %12.0f msg/s\n",
+         w.name.c_str(), v.name, msgs > 0 ? r.elapsed * 1e9 / msgs : 0,
+         r.rounds * scanned_bytes(w) / r.elapsed / (1024 * 1024),
+         msgs / r.elapsed);
+  if (w.skipped > 0) {
+    printf("%-41s body skip: %.2f MB/s with the %lu body bytes that are not scanned\n",
+           "", r.rounds * w.bytes / r.elapsed / (1024 * 1024),
+           (unsigned long) w.skipped);
+  }
+  report_counters(w, r);
+
+  if (r.latency.total > 0) {
+    printf("%-41s latency ns: p50 %llu p90 %llu p99 %llu p99.9 %llu max %llu\n", "",
+           (unsigned long long) r.latency.percentile(50),
+           (unsigned long long) r.latency.percentile(90),
+           (unsigned long long) r.latency.percentile(99),
+           (unsigned long long) r.latency.percentile(99.9),
+           (unsigned long long) r.latency.max);
+  }
+
+  if (r.errors > 0) {
+    printf("%-41s %lu of %lu streams failed:", "", r.errors,
+           (unsigned long) w.streams.size());
+    for (const auto& e : r.error_names) {
+      printf(" %s %lu", e.first.c_str(), e.second);
+    }
+    printf("\n");
+  }
+}
+
+/* Cycles per byte of R, or ns per byte without counters */
+static double cost_per_byte(const workload& w, const result& r) {
+  double bytes = (double) r.rounds * scanned_bytes(w);
+
+  if (r.counts[CYCLES] >= 0) {
+    return r.counts[CYCLES] / bytes;
+  }
+  return r.elapsed * 1e9 / bytes;
+}
+
+static void json_begin(FILE *f, double seconds, size_t read_size) {
+  fprintf(f, "{\"compiler\": %s,\n \"flags\": %s,\n \"cpu\": %s,\n"
+             " \"seconds\": %g,\n \"read_size\": \"%s\",\n \"results\": [\n",
+          json_string(BENCH_COMPILER).c_str(), json_string(BENCH_FLAGS).c_str(),
+          json_string(cpu_model()).c_str(), seconds, read_size_name(read_size));
+}
+
+static void json_result(FILE *f, bool first, const workload& w,
+                        const variant& v, const result& r) {
+  double msgs = (double) r.rounds * r.messages;
+  double bytes = (double) r.rounds * w.bytes;
+  const double *c = r.counts;
+
+  fprintf(f, "%s  {\"workload\": %s, \"variant\": \"%s\", "
+             "\"ns_per_msg\": %.4g, \"mb_per_s\": %.4g, \"skip_mb_per_s\": %s, "
+             "\"msg_per_s\": %.4g, "
+             "\"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, "
+             "\"p999_ns\": %llu, \"max_ns\": %llu, \"errors\": %lu, "
+             "\"cycles_per_byte\": %s, \"ipc\": %s, \"branch_miss_rate\": %s}",
+          first ? "" : ",\n", json_string(w.name).c_str(), v.name,
+          msgs > 0 ? r.elapsed * 1e9 / msgs : 0,
+          (double) r.rounds * scanned_bytes(w) / r.elapsed / (1024 * 1024),
+          json_number(w.skipped > 0 ? bytes / r.elapsed / (1024 * 1024) : -1).c_str(),
+          msgs / r.elapsed,
+          (unsigned long long) r.latency.percentile(50),
+          (unsigned long long) r.latency.percentile(90),
+          (unsigned long long) r.latency.percentile(99),
+          (unsigned long long) r.latency.percentile(99.9),
+          (unsigned long long) r.latency.max, r.errors,
+          json_number(c[CYCLES] < 0 ? -1 : c[CYCLES] / bytes).c_str(),
+          json_number(c[CYCLES] <= 0 || c[INSTRUCTIONS] < 0 ? -1
+                      : c[INSTRUCTIONS] / c[CYCLES]).c_str(),
+          json_number(c[BRANCHES] <= 0 || c[BRANCH_MISSES] < 0 ? -1
+                      : c[BRANCH_MISSES] / c[BRANCHES]).c_str());
+}
+
+static void json_end(FILE *f) {
+  fprintf(f, "\n]}\n");
+}
+
+/* Value of "KEY": in LINE, a line of json_result() */
+static std::string json_field(const char *line, const char *key) {
+  std::string k = std::string("\"") + key + "\": ";
+  const char *p = strstr(line, k.c_str());
+  const char *end;
+
+  if (p == NULL) {
+    return "";
+  }
+  p += k.size();
+  if (*p == '"') {
+    for (end = ++p; *end != '\0' && *end != '"'; end++) {
+      if (*end == '\\' && end[1] != '\0') {
+        end++;
+      }
+    }
+  } else {
+    end = p + strcspn(p, ",}");
+  }
+  return std::string(p, end - p);
+}
+
+/* workload/variant -> ns/msg of the results in NAME */
+static bool load_results(const char *name, std::map<std::string, double>& out) {
+  char line[4096];
+  FILE *f = fopen(name, "r");
+
+  if (f == NULL) {
+    perror(name);
+    return false;
+  }
+  while (fgets(line, sizeof(line), f) != NULL) {
+    std::string w = json_field(line, "workload");
+    if (!w.empty()) {
+      out[w + "/" + json_field(line, "variant")] =
+        atof(json_field(line, "ns_per_msg").c_str());
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+/* -c: 1 if a workload of NEW is slower than in BASE by more than THRESHOLD % */
+static int compare(const char *base, const char *next, double threshold) {
+  std::map<std::string, double> before, after;
+  int regressions = 0;
+  double change;
+
+  if (!load_results(base, before) || !load_results(next, after)) {
+    return 2;
+  }
+
+  for (const auto& b : before) {
+    auto a = after.find(b.first);
+    if (a == after.end() || b.second <= 0) {
+      continue;
+    }
+    change = 100 * (a->second - b.second) / b.second;
+    printf("%-38s %10.1f -> %10.1f ns/msg %+7.1f%%%s\n", b.first.c_str(),
+           b.second, a->second, change,
+           change > threshold ? "  REGRESSION" : "");
+    if (change > threshold) {
+      regressions++;
+    }
+  }
+
+  if (regressions > 0) {
+    printf("%d regression(s) beyond %.1f%%\n", regressions, threshold);
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  const char *only_workload = NULL;
+  const char *only_variant = NULL;
+  double seconds = 0.5;
+  size_t read_size = 0;
+  bool sweep = false;
+  int max_threads = 0;
+  bool pin = false;
+  const char *json_name = NULL;
+  FILE *json = NULL;
+  bool first = true;
+  const workload *worst_workload = NULL;
+  const variant *worst_variant = NULL;
+  double worst = 0;
+  bool builtin = false;
+  std::string url = long_url(true);
+  workload url_workload = { "adv_parse_url", {}, url.size(), 1, false };
+  std::vector<workload> workloads;
+  result r, whole;
+  int i;
+
+  http_parser::parser_settings settings;
+  settings.on_message_begin = on_info;
+  settings.on_url = on_data;
+  settings.on_header_field = on_data;
+  settings.on_header_value = on_data;
+  settings.on_headers_complete = on_data;
+  settings.on_body = on_data;
+  settings.on_message_complete = on_message_complete;
+  settings.on_reason = on_data;
+  settings.on_chunk_header = on_info;
+  settings.on_chunk_complete = on_info;
+
+  if (argc == 2 && strcmp(argv[1], "infinite") == 0) {
+    workloads = make_workloads();
+    for (;;) {
+      run(workloads[1], variants[0], settings, 1, 0, false, r);
+    }
+  }
+
+  if (argc >= 4 && strcmp(argv[1], "-c") == 0) {
+    return compare(argv[2], argv[3], argc >= 6 && strcmp(argv[4], "-T") == 0
+                                     ? atof(argv[5]) : 5);
+  }
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      seconds = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      i++;
+      read_size = strcmp(argv[i], "random") == 0
+                ? random_reads : strtoul(argv[i], NULL, 10);
+    } else if (strcmp(argv[i], "-s") == 0) {
+      sweep = true;
+    } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      max_threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-p") == 0) {
+      pin = true;
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      json_name = argv[++i];
+    } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+      only_workload = argv[++i];
+    } else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc) {
+      only_variant = argv[++i];
+    } else if (argv[i][0] != '-') {
+      if (!load_capture(argv[i], workloads)) {
+        return 1;
+      }
+    } else {
+      fprintf(stderr, "usage: %s [-t seconds] [-r read_size] [-w workload] "
+                      "[-v variant] [-o json] [file...]\n"
+                      "       %s -s [-t seconds] [-w workload] [-v variant] "
+                      "[file...]\n"
+                      "       %s -j threads [-p] [-t seconds] [-r read_size] "
+                      "[-w workload] [-v variant] [file...]\n"
+                      "       %s -c base.json new.json [-T percent]\n"
+                      "       %s infinite\n",
+              argv[0], argv[0], argv[0], argv[0], argv[0]);
+      return 1;
+    }
+  }
+
+  if (workloads.empty()) {
+    workloads = make_workloads();
+    builtin = true;
+  }
+
+  if (json_name != NULL) {
+    json = fopen(json_name, "w");
+    if (json == NULL) {
+      perror(json_name);
+      return 1;
+    }
+    json_begin(json, seconds, read_size);
+  }
+
+  open_counters();
+  calibrate_ticks();
+
+  for (const workload& w : workloads) {
+    if (only_workload != NULL && w.name != only_workload) {
+      continue;
+    }
+
+    for (const variant& v : variants) {
+      if ((only_variant != NULL && strcmp(only_variant, v.name) != 0) ||
+          !can_parse(v, w)) {
+        continue;
+      }
+
+      if (max_threads > 0) {
+        report_scaling(w, v, settings, seconds, read_size, max_threads, pin);
+        continue;
+      }
+
+      if (sweep) {
+        for (size_t split : split_sizes) {
+          run(w, v, settings, seconds, split, false, split == 0 ? whole : r);
+          report_split(w, v, split, split == 0 ? whole : r, whole);
+        }
+        continue;
+      }
+
+      run(w, v, settings, seconds, read_size, true, r);
+      if (!w.capture && (r.errors > 0 || r.messages != w.messages)) {
+        fprintf(stderr, "%s/%s: %lu messages, expected %lu\n", w.name.c_str(),
+                v.name, r.messages, w.messages);
+        return 1;
+      }
+      report(w, v, r);
+      if (worst_workload == NULL || cost_per_byte(w, r) > worst) {
+        worst = cost_per_byte(w, r);
+        worst_workload = &w;
+        worst_variant = &v;
+      }
+      if (json != NULL) {
+        json_result(json, first, w, v, r);
+        first = false;
+      }
+    }
+  }
+
+  if (builtin && max_threads == 0 && !sweep &&
+      (only_workload == NULL || url_workload.name == only_workload) &&
+      (only_variant == NULL || strcmp(only_variant, parse_url_variant.name) == 0)) {
+    run_parse_url(url, seconds, r);
+    if (r.errors > 0) {
+      fprintf(stderr, "%s: the URL does not parse\n", url_workload.name.c_str());
+      return 1;
+    }
+    report(url_workload, parse_url_variant, r);
+    if (worst_workload == NULL || cost_per_byte(url_workload, r) > worst) {
+      worst = cost_per_byte(url_workload, r);
+      worst_workload = &url_workload;
+      worst_variant = &parse_url_variant;
+    }
+    if (json != NULL) {
+      json_result(json, first, url_workload, parse_url_variant, r);
+      first = false;
+    }
+  }
+
+  if (worst_workload != NULL) {
+    printf("worst case: %s/%s %.2f %s\n", worst_workload->name.c_str(),
+           worst_variant->name, worst,
+           counter_fds[CYCLES] >= 0 ? "cycles/B" : "ns/B");
+  }
+
+  if (json != NULL) {
+    json_end(json);
+    fclose(json);
+  }
+
+  return 0;
+}
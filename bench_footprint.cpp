@@ -0,0 +1,134 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Memory footprint of many idle keep-alive connections: constructs COUNT
+ * parsers (one million by default), runs a request through each and parks
+ * it in the middle of the next one, then reports the resident set size.
+ *
+ *   ./bench_footprint [count]
+ */
+
+#include "http_parser.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <vector>
+
+static const char request[] =
+    "GET /favicon.ico HTTP/1.1\r\n"
+    "Host: 0.0.0.0=5000\r\n"
+    "Accept: */*\r\n"
+    "Keep-Alive: 300\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+static const char partial[] =
+    "POST /upload HTTP/1.1\r\n"
+    "Host: 0.0.0.0=5000\r\n"
+    "Content-Le";
+
+/* Current resident set size in KB */
+static long rss_kb(void) {
+  long pages = 0;
+  FILE *f = fopen("/proc/self/statm", "r");
+
+  if (f != NULL) {
+    if (fscanf(f, "%*s %ld", &pages) != 1) {
+      pages = 0;
+    }
+    fclose(f);
+  }
+
+  if (pages > 0) {
+    return pages * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+
+  /* No procfs; the peak is the best we can do */
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss;
+}
+
+static int on_info(http_parser&) {
+  return 0;
+}
+
+static int on_data(http_parser&, const char *, size_t) {
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  size_t count = 1000000;
+  size_t i;
+
+  if (argc > 1) {
+    count = strtoul(argv[1], NULL, 10);
+  }
+
+  http_parser::parser_settings settings;
+  settings.on_message_begin = on_info;
+  settings.on_url = on_data;
+  settings.on_header_field = on_data;
+  settings.on_header_value = on_data;
+  settings.on_headers_complete = on_data;
+  settings.on_body = on_data;
+  settings.on_message_complete = on_info;
+  settings.on_reason = on_data;
+  settings.on_chunk_header = on_info;
+  settings.on_chunk_complete = on_info;
+
+  long base = rss_kb();
+
+  std::vector<http_parser> parsers;
+  parsers.reserve(count);
+  for (i = 0; i < count; i++) {
+    parsers.emplace_back(http_parser::HTTP_REQUEST);
+  }
+
+  long constructed = rss_kb();
+
+  for (i = 0; i < count; i++) {
+    http_parser &p = parsers[i];
+    p.execute(settings, request, sizeof(request) - 1);
+    p.execute(settings, partial, sizeof(partial) - 1);
+    if (strcmp(p.get_errno().name(), "HPE_OK") != 0) {
+      fprintf(stderr, "parser %lu: %s\n", (unsigned long) i,
+              p.get_errno().description());
+      return 1;
+    }
+  }
+
+  long exercised = rss_kb();
+
+  printf("sizeof(http_parser) = %u\n", (unsigned int) sizeof(http_parser));
+  printf("%lu parsers\n", (unsigned long) count);
+  printf("constructed: %8.2f MB RSS, %6.2f bytes/parser\n",
+         (constructed - base) / 1024.0,
+         (constructed - base) * 1024.0 / count);
+  printf("exercised:   %8.2f MB RSS, %6.2f bytes/parser\n",
+         (exercised - base) / 1024.0,
+         (exercised - base) * 1024.0 / count);
+
+  return 0;
+}
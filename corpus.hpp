@@ -0,0 +1,137 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* The requests and responses of the test suite, each with everything
+ * execute() has to report for it. They are real-world messages and the
+ * edge cases that broke parsers before; test.cpp checks every one of
+ * them split at every offset, paused at every callback and pipelined, and
+ * bench parses them as its corpus workloads.
+ */
+
+#pragma once
+
+#include "http_parser.hpp"
+
+namespace corpus {
+
+static const int max_headers = 13;
+
+struct message {
+  const char *name = NULL;  /* for debugging purposes */
+  http_parser::http_parser_type type = http_parser::HTTP_REQUEST;
+  const char *raw = "";
+  bool should_keep_alive = false;
+  bool message_complete_on_eof = false;
+  unsigned short http_major = 0;
+  unsigned short http_minor = 0;
+  http_parser::http_method method = http_parser::HTTP_DELETE;  /* requests */
+  int status_code = 0;                                          /* responses */
+  const char *response_status = "";                             /* responses */
+  const char *query_string = "";
+  const char *fragment = "";
+  const char *request_path = "";
+  const char *request_url = "";
+  const char *host = NULL;      /* not checked if NULL */
+  const char *userinfo = NULL;  /* not checked if NULL */
+  uint16_t port = 0;
+  int num_headers = 0;
+  const char *upgrade = NULL;   /* the data after the headers of a message
+                                 * that upgrades the connection */
+  const char *headers[max_headers][2] = {};
+  size_t body_size = 0;         /* if set, only the size of the body is checked */
+  const char *body = "";
+};
+
+/* Indices into requests[] and responses[]. Some of the messages only
+ * parse without HTTP_PARSER_STRICT.
+ */
+enum request_index
+  { CURL_GET
+  , FIREFOX_GET
+  , DUMBFUCK
+  , FRAGMENT_IN_URI
+  , GET_NO_HEADERS_NO_BODY
+  , GET_ONE_HEADER_NO_BODY
+  , GET_FUNKY_CONTENT_LENGTH
+  , POST_IDENTITY_BODY_WORLD
+  , POST_CHUNKED_ALL_YOUR_BASE
+  , TWO_CHUNKS_MULT_ZERO_END
+  , CHUNKED_W_TRAILING_HEADERS
+  , CHUNKED_W_BULLSHIT_AFTER_LENGTH
+  , WITH_QUOTES
+  , APACHEBENCH_GET
+  , QUERY_URL_WITH_QUESTION_MARK_GET
+  , PREFIX_NEWLINE_GET
+  , UPGRADE_REQUEST
+  , CONNECT_REQUEST
+  , REPORT_REQ
+  , NO_HTTP_VERSION
+  , MSEARCH_REQ
+  , LINE_FOLDING_IN_HEADER
+  , QUERY_TERMINATED_HOST
+  , QUERY_TERMINATED_HOSTPORT
+  , SPACE_TERMINATED_HOSTPORT
+  , PATCH_REQ
+  , CONNECT_CAPS_REQUEST
+#if !HTTP_PARSER_STRICT
+  , UTF8_PATH_REQ
+  , HOSTNAME_UNDERSCORE
+  , BARE_CR_IN_HEADER_VALUE
+#endif
+  , EAT_TRAILING_CRLF_NO_CONNECTION_CLOSE
+  , EAT_TRAILING_CRLF_WITH_CONNECTION_CLOSE
+  , LINE_FOLDING_IN_HEADER_WITH_LF
+  , CONNECTION_MULTI
+  , NUM_REQUESTS
+  };
+
+enum response_index
+  { GOOGLE_301
+  , NO_CONTENT_LENGTH_RESPONSE
+  , NO_HEADERS_NO_BODY_404
+  , NO_REASON_PHRASE
+  , TRAILING_SPACE_ON_CHUNKED_BODY
+  , NO_CARRIAGE_RET
+  , PROXY_CONNECTION
+  , UNDERSTORE_HEADER_KEY
+  , BONJOUR_MADAME_FR
+  , RES_FIELD_UNDERSCORE
+  , NON_ASCII_IN_STATUS_LINE
+  , HTTP_VERSION_0_9
+  , NO_CONTENT_LENGTH_NO_TRANSFER_ENCODING_RESPONSE
+  , NO_BODY_HTTP10_KA_200
+  , NO_BODY_HTTP10_KA_204
+  , NO_BODY_HTTP11_KA_200
+  , NO_BODY_HTTP11_KA_204
+  , NO_BODY_HTTP11_NOKA_204
+  , NO_BODY_HTTP11_KA_CHUNKED_200
+#if !HTTP_PARSER_STRICT
+  , SPACE_IN_FIELD_RES
+#endif
+  , AMAZON_COM
+  , EMPTY_REASON_PHRASE_AFTER_SPACE
+  , NUM_RESPONSES
+  };
+
+extern const message requests[NUM_REQUESTS];
+extern const message responses[NUM_RESPONSES];
+
+}  // namespace corpus
@@ -0,0 +1,550 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Performance fuzzing of execute() and http_parser_parse_url(). The first
+ * byte of an input picks the target (see enum target), the rest is parsed.
+ *
+ * Every input given to execute() is parsed three times: in one buffer, one
+ * byte at a time and in one buffer by the direct-threaded state machine.
+ * The callbacks of the three runs, where the parser stopped and its error
+ * must be identical, or the input is reported and the process aborts; only
+ * the token in progress at an error may have been delivered in part by the
+ * byte by byte run. URLs are checked to have every field inside the buffer.
+ *
+ * The cost of the one-buffer run is then measured in instructions
+ * (perf_event_open(2)) or, where counters are unavailable, in ns. An input
+ * of at least HTTP_PARSER_FUZZ_MIN_LEN bytes (256) that costs more than
+ * HTTP_PARSER_FUZZ_THRESHOLD per byte (200 instructions or 50 ns; 0 turns
+ * this off) is saved as slow-HASH in HTTP_PARSER_FUZZ_DIR (the current
+ * directory). The cost per byte is also fed back to libFuzzer as extra
+ * counters, one per target and power of sqrt(2), so an input slower per
+ * byte than any before counts as new coverage and is kept for mutation.
+ *
+ *   make fuzz fuzz-seeds && ./fuzz -max_len=65536 fuzz_seeds/
+ *
+ * builds and runs it with libFuzzer (clang); sanitizers can be added with
+ * CXXFLAGS_FUZZ_EXTRA, at the price of skewing the costs. Without libFuzzer, fuzz_standalone
+ * runs the messages of corpus.hpp and every FILE, then RUNS (0 by
+ * default) mutations of them, keeping those that reach a new counter:
+ *
+ *   ./fuzz_standalone [-n runs] [file...]
+ *   ./fuzz_standalone -w dir
+ *
+ * -w writes the corpus messages to DIR as seeds for libFuzzer instead.
+ */
+
+#include "http_parser.hpp"
+#include "test_helpers.hpp"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+# include <linux/perf_event.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#ifdef FUZZ_STANDALONE
+# include "corpus.hpp"
+# include <errno.h>
+# include <algorithm>
+# include <vector>
+#endif
+
+#include <string>
+
+/* Bits 0-1 of the first byte; bit 2 is is_connect for TARGET_URL */
+enum target
+  { TARGET_REQUEST
+  , TARGET_RESPONSE
+  , TARGET_BOTH
+  , TARGET_URL
+  , NUM_TARGETS
+  };
+
+static const int num_buckets = 32;
+
+/* counters[t][b] is set once an input of target t has cost 2^(b/2) or
+ * more per byte. libFuzzer reads the section as coverage.
+ */
+#ifdef __linux__
+__attribute__((used, section("__libfuzzer_extra_counters")))
+#endif
+static uint8_t counters[NUM_TARGETS][num_buckets];
+
+static struct {
+  bool initialized;
+  int instructions_fd;    /* < 0: costs are in ns */
+  const char *unit;
+  double threshold;       /* per byte; 0 if off */
+  size_t min_len;
+  const char *dir;
+} options;
+
+static unsigned long slow_inputs;
+static double worst_per_byte;
+
+static void init(void) {
+  const char *env;
+
+  options.initialized = true;
+  options.instructions_fd = -1;
+  options.unit = "ns";
+
+#ifdef __linux__
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  options.instructions_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  if (options.instructions_fd >= 0) {
+    options.unit = "instructions";
+  }
+#endif
+
+  env = getenv("HTTP_PARSER_FUZZ_THRESHOLD");
+  options.threshold = env != NULL ? atof(env)
+                    : options.instructions_fd >= 0 ? 200 : 50;
+  env = getenv("HTTP_PARSER_FUZZ_MIN_LEN");
+  options.min_len = env != NULL ? strtoul(env, NULL, 10) : 256;
+  env = getenv("HTTP_PARSER_FUZZ_DIR");
+  options.dir = env != NULL ? env : ".";
+}
+
+static uint64_t cost_now(void) {
+#ifdef __linux__
+  uint64_t n;
+
+  if (options.instructions_fd >= 0) {
+    return read(options.instructions_fd, &n, sizeof(n)) == sizeof(n) ? n : 0;
+  }
+#endif
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* The input of the current run */
+static const uint8_t *current_input;
+static size_t current_size;
+
+/* Writes the current input to PREFIX-HASH in options.dir */
+static bool save(const char *prefix, std::string& name) {
+  uint64_t hash = 14695981039346656037ull;  /* FNV-1a */
+  char buf[64];
+  size_t i;
+  FILE *f;
+
+  for (i = 0; i < current_size; i++) {
+    hash = (hash ^ current_input[i]) * 1099511628211ull;
+  }
+  snprintf(buf, sizeof(buf), "/%s-%016llx", prefix, (unsigned long long) hash);
+  name = std::string(options.dir) + buf;
+
+  f = fopen(name.c_str(), "wb");
+  if (f == NULL || fwrite(current_input, 1, current_size, f) != current_size) {
+    perror(name.c_str());
+    if (f != NULL) {
+      fclose(f);
+    }
+    return false;
+  }
+  fclose(f);
+  return true;
+}
+
+/* libFuzzer keeps the input of a crash itself */
+static void fail(void) {
+#ifdef FUZZ_STANDALONE
+  std::string name;
+
+  if (save("crash", name)) {
+    fprintf(stderr, "input saved as %s\n", name.c_str());
+  }
+#endif
+  abort();
+}
+
+/* The differential check, on traces of the callbacks (test_helpers.hpp) */
+
+static test_helpers::trace tracer;
+
+enum feeding { ONE_BUFFER, BYTE_BY_BYTE, THREADED };
+
+static const char *feeding_names[] = { "in one buffer", "byte by byte", "threaded" };
+
+static size_t feed(http_parser& parser, const http_parser::parser_settings& settings,
+                   feeding f, const char *data, size_t len) {
+  if (f == THREADED) {
+    return parser.execute<http_parser_threaded>(settings, data, len);
+  }
+  return parser.execute(settings, data, len);
+}
+
+/* Parses DATA and then EOF, unless the parser stopped before */
+static std::string parse_traced(const http_parser::parser_settings& settings,
+                                http_parser::http_parser_type type, feeding f,
+                                const char *data, size_t len) {
+  http_parser parser(type);
+  char buf[96];
+  size_t nparsed = 0, n;
+
+  tracer.clear();
+
+  if (f == BYTE_BY_BYTE) {
+    while (nparsed < len) {
+      n = feed(parser, settings, f, data + nparsed, 1);
+      nparsed += n;
+      if (n != 1 || tracer.upgraded) {
+        break;
+      }
+    }
+  } else if (len > 0) {
+    nparsed = feed(parser, settings, f, data, len);
+  }
+
+  if (nparsed == len && !tracer.upgraded) {
+    feed(parser, settings, f, NULL, 0);
+  }
+
+  snprintf(buf, sizeof(buf), "\nend %s at %lu%s", parser.get_errno().name(),
+           (unsigned long) nparsed, tracer.upgraded ? " upgrade" : "");
+  tracer.out.append(buf);
+  return tracer.out;
+}
+
+/* Whether ACTUAL, parsed byte by byte, is EXPECTED. If the parse failed,
+ * the data callbacks already ran for the bytes of the failing token that
+ * came before the error, so ACTUAL may go on with one data event.
+ */
+static bool same_callbacks(const std::string& expected, const std::string& actual) {
+  size_t end = expected.rfind("\nend ");
+  size_t actual_end = actual.rfind("\nend ");
+  size_t extra;
+
+  if (expected.compare(end, std::string::npos, actual, actual_end, std::string::npos) != 0 ||
+      actual_end < end || actual.compare(0, end, expected, 0, end) != 0) {
+    return false;
+  }
+  if (actual_end == end) {
+    return true;
+  }
+  if (expected.compare(end, 11, "\nend HPE_OK") == 0) {
+    return false;
+  }
+
+  /* the rest of the last data event, or one more */
+  extra = actual.find('\n', end);
+  if (extra == end) {
+    extra = actual.find('\n', end + 1);
+    if (actual.find(':', end) > extra) {
+      return false;
+    }
+  }
+  return extra == actual_end;
+}
+
+static void check_execute(http_parser::http_parser_type type,
+                          const char *data, size_t len) {
+  static const http_parser::parser_settings settings =
+    test_helpers::tracing_settings(tracer);
+  std::string expected, actual;
+  int f;
+
+  expected = parse_traced(settings, type, ONE_BUFFER, data, len);
+  for (f = BYTE_BY_BYTE; f <= THREADED; f++) {
+    actual = parse_traced(settings, type, (feeding) f, data, len);
+    if (f == BYTE_BY_BYTE ? !same_callbacks(expected, actual) : actual != expected) {
+      fprintf(stderr, "callbacks differ when parsed %s\n"
+              "in one buffer:%s\n\n%s:%s\n", feeding_names[f],
+              expected.c_str(), feeding_names[f], actual.c_str());
+      fail();
+    }
+  }
+}
+
+static void check_url(const char *data, size_t len, int is_connect) {
+  struct http_parser_url u;
+  int i;
+
+  memset(&u, 0, sizeof(u));
+  if (http_parser_parse_url(data, len, is_connect, &u) != 0) {
+    return;
+  }
+
+  for (i = 0; i < UF_MAX; i++) {
+    if ((u.field_set & (1 << i)) &&
+        (size_t) u.field_data[i].off + u.field_data[i].len > len) {
+      fprintf(stderr, "field %d of the URL (%u + %u) is outside its %lu bytes\n",
+              i, u.field_data[i].off, u.field_data[i].len, (unsigned long) len);
+      fail();
+    }
+  }
+}
+
+/* Instructions or ns to parse DATA once, without tracing */
+static double cost(int t, int is_connect, const char *data, size_t len) {
+  static const http_parser::parser_settings settings = test_helpers::null_settings();
+  static const http_parser::http_parser_type types[] =
+    { http_parser::HTTP_REQUEST, http_parser::HTTP_RESPONSE, http_parser::HTTP_BOTH };
+  struct http_parser_url u;
+  uint64_t start;
+
+  if (t == TARGET_URL) {
+    start = cost_now();
+    http_parser_parse_url(data, len, is_connect, &u);
+    return cost_now() - start;
+  }
+
+  http_parser parser(types[t]);
+  size_t nparsed;
+
+  start = cost_now();
+  nparsed = parser.execute(settings, data, len);
+  if (nparsed == len && !parser.has_upgrade()) {
+    parser.execute(settings, NULL, 0);
+  }
+  return cost_now() - start;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *input, size_t size) {
+  static const http_parser::http_parser_type types[] =
+    { http_parser::HTTP_REQUEST, http_parser::HTTP_RESPONSE, http_parser::HTTP_BOTH };
+  const char *data = (const char *) input + 1;
+  size_t len = size - 1;
+  double per_byte;
+  int t, is_connect, bucket, i;
+
+  if (size == 0) {
+    return 0;
+  }
+  if (!options.initialized) {
+    init();
+  }
+  current_input = input;
+  current_size = size;
+
+  t = input[0] & 3;
+  is_connect = (input[0] >> 2) & 1;
+
+  if (t == TARGET_URL) {
+    check_url(data, len, is_connect);
+  } else {
+    check_execute(types[t], data, len);
+  }
+
+  /* the fixed cost of a call would dominate short inputs */
+  if (len < options.min_len) {
+    return 0;
+  }
+
+  per_byte = cost(t, is_connect, data, len) / len;
+
+  /* a new worst or slow input is measured again, as a preemption may have
+   * been timed
+   */
+  if (per_byte > worst_per_byte ||
+      (options.threshold > 0 && per_byte > options.threshold)) {
+    for (i = 0; i < 2; i++) {
+      per_byte = fmin(per_byte, cost(t, is_connect, data, len) / len);
+    }
+  }
+
+  bucket = per_byte < 1 ? 0 : (int) (2 * log2(per_byte)) + 1;
+  if (bucket >= num_buckets) {
+    bucket = num_buckets - 1;
+  }
+  counters[t][bucket] = 1;
+
+  if (options.threshold > 0 && per_byte > options.threshold) {
+    std::string name;
+
+    if (save("slow", name)) {
+      fprintf(stderr, "slow input: %.1f %s/B, saved as %s\n", per_byte,
+              options.unit, name.c_str());
+    }
+    slow_inputs++;
+  }
+  if (per_byte > worst_per_byte) {
+    worst_per_byte = per_byte;
+  }
+
+  return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+
+using test_helpers::next_random;
+
+static const size_t max_input = 65536;
+
+/* One to four random edits of IN; OTHER is spliced from. Repeating a
+ * range is what finds costs that grow with the input.
+ */
+static std::string mutate(const std::string& in, const std::string& other,
+                          uint32_t& seed) {
+  static const char interesting[] = " \t\r\n:;,=\"\\/?#%@[]0123456789aAfF";
+  std::string s = in;
+  size_t pos, len;
+  int edits = next_random(seed) % 4 + 1;
+
+  while (edits-- > 0) {
+    pos = s.size() > 1 ? next_random(seed) % (s.size() - 1) + 1 : s.size();
+    len = next_random(seed) % 32 + 1;
+    switch (next_random(seed) % 5) {
+    case 0:
+      if (pos < s.size()) {
+        s[pos] ^= 1 << (next_random(seed) % 8);
+      }
+      break;
+    case 1:
+      s.insert(pos, 1, next_random(seed) % 2
+               ? interesting[next_random(seed) % (sizeof(interesting) - 1)]
+               : (char) next_random(seed));
+      break;
+    case 2:
+      s.erase(pos, len);
+      break;
+    case 3:
+      len = std::min(len, s.size() - pos);
+      for (int n = next_random(seed) % 256 + 1; n > 0; n--) {
+        s.insert(pos, s, pos, len);
+        if (s.size() > max_input) {
+          break;
+        }
+      }
+      break;
+    case 4:
+      if (other.size() > 1) {
+        size_t from = next_random(seed) % (other.size() - 1) + 1;
+        s.insert(pos, other, from, len);
+      }
+      break;
+    }
+  }
+
+  if (s.size() > max_input) {
+    s.resize(max_input);
+  }
+  return s;
+}
+
+/* The corpus messages, and the URLs of its requests */
+static std::vector<std::string> seeds(void) {
+  std::vector<std::string> s;
+  int i;
+
+  for (i = 0; i < corpus::NUM_REQUESTS; i++) {
+    const corpus::message& m = corpus::requests[i];
+    s.push_back(std::string(1, TARGET_REQUEST) + m.raw);
+    s.push_back(std::string(1, TARGET_BOTH) + m.raw);
+    if (m.request_url[0] != '\0') {
+      s.push_back(std::string(1, TARGET_URL |
+                              (m.method == http_parser::HTTP_CONNECT ? 4 : 0)) +
+                  m.request_url);
+    }
+  }
+  for (i = 0; i < corpus::NUM_RESPONSES; i++) {
+    s.push_back(std::string(1, TARGET_RESPONSE) + corpus::responses[i].raw);
+  }
+
+  return s;
+}
+
+static int write_seeds(const char *dir) {
+  std::vector<std::string> s = seeds();
+  char name[4096];
+  size_t i;
+  FILE *f;
+
+  for (i = 0; i < s.size(); i++) {
+    snprintf(name, sizeof(name), "%s/seed-%03lu", dir, (unsigned long) i);
+    f = fopen(name, "wb");
+    if (f == NULL || fwrite(s[i].data(), 1, s[i].size(), f) != s[i].size()) {
+      fprintf(stderr, "%s: %s\n", name, strerror(errno));
+      return 1;
+    }
+    fclose(f);
+  }
+
+  printf("%lu seeds written to %s\n", (unsigned long) s.size(), dir);
+  return 0;
+}
+
+static void run(const std::string& input) {
+  LLVMFuzzerTestOneInput((const uint8_t *) input.data(), input.size());
+}
+
+int main(int argc, char **argv) {
+  unsigned long runs = 0, i, kept = 0;
+  uint32_t seed = 2463534242u;
+  uint8_t before[NUM_TARGETS][num_buckets];
+  std::vector<std::string> pool;
+  int first = 1, f;
+
+  if (argc > 2 && strcmp(argv[1], "-w") == 0) {
+    return write_seeds(argv[2]);
+  }
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    runs = strtoul(argv[2], NULL, 10);
+    first = 3;
+  }
+
+  pool = seeds();
+  for (f = first; f < argc; f++) {
+    pool.emplace_back();
+    if (!test_helpers::load(argv[f], pool.back())) {
+      return 1;
+    }
+  }
+
+  for (const std::string& input : pool) {
+    run(input);
+  }
+
+  for (i = 0; i < runs; i++) {
+    const std::string& in = pool[next_random(seed) % pool.size()];
+    const std::string& other = pool[next_random(seed) % pool.size()];
+    std::string input = mutate(in, other, seed);
+
+    memcpy(before, counters, sizeof(before));
+    run(input);
+    if (memcmp(before, counters, sizeof(before)) != 0) {
+      pool.push_back(input);
+      kept++;
+    }
+  }
+
+  printf("%lu inputs and %lu runs, %lu kept, %lu slow; worst %.1f %s/B\n",
+         (unsigned long) (pool.size() - kept), runs, kept, slow_inputs,
+         worst_per_byte, options.unit);
+  return 0;
+}
+
+#endif  /* FUZZ_STANDALONE */
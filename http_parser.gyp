@@ -29,8 +29,13 @@
         },
       }
     },
+    'cflags_cc': [ '-std=c++20' ],
+    'xcode_settings': {
+      'CLANG_CXX_LANGUAGE_STANDARD': 'c++20',
+    },
     'msvs_settings': {
       'VCCLCompilerTool': {
+        'AdditionalOptions': [ '/std:c++20' ],
       },
       'VCLibrarianTool': {
       },
@@ -57,13 +62,12 @@
         'include_dirs': [ '.' ],
       },
       'defines': [ 'HTTP_PARSER_STRICT=0' ],
-      'sources': [ './http_parser.c', ],
+      'sources': [ './http_parser.cpp', ],
       'conditions': [
         ['OS=="win"', {
           'msvs_settings': {
             'VCCLCompilerTool': {
-              # Compile as C++. http_parser.c is actually C99, but C++ is
-              # close enough in this case.
+              # Compile as C++.
               'CompileAs': 2,
             },
           },
@@ -80,13 +84,12 @@
         'include_dirs': [ '.' ],
       },
       'defines': [ 'HTTP_PARSER_STRICT=1' ],
-      'sources': [ './http_parser.c', ],
+      'sources': [ './http_parser.cpp', ],
       'conditions': [
         ['OS=="win"', {
           'msvs_settings': {
             'VCCLCompilerTool': {
-              # Compile as C++. http_parser.c is actually C99, but C++ is
-              # close enough in this case.
+              # Compile as C++.
               'CompileAs': 2,
             },
           },
@@ -98,14 +101,14 @@
       'target_name': 'test-nonstrict',
       'type': 'executable',
       'dependencies': [ 'http_parser' ],
-      'sources': [ 'test.c' ]
+      'sources': [ 'corpus.cpp', 'test_helpers.cpp', 'test.cpp' ]
     },
 
     {
       'target_name': 'test-strict',
       'type': 'executable',
       'dependencies': [ 'http_parser_strict' ],
-      'sources': [ 'test.c' ]
+      'sources': [ 'corpus.cpp', 'test_helpers.cpp', 'test.cpp' ]
     }
   ]
 }
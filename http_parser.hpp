@@ -42,20 +42,55 @@ typedef int ssize_t;
 #include <stdint.h>
 #endif
 
+#include <cassert>
 #include <cstdint>
 
 #include <functional>
+#include <type_traits>
+#include <vector>
 
 /* Compile with -DHTTP_PARSER_STRICT=1 to parse URLs and hostnames
- * strictly according to the RFCs
+ * strictly according to the RFCs by default. Both behaviours are always
+ * available through execute<http_parser_strict>() and
+ * execute<http_parser_lenient>().
  */
 #ifndef HTTP_PARSER_STRICT
 # define HTTP_PARSER_STRICT 0
 #endif
 
+/* Compile with -DHTTP_PARSER_HEADER_ONLY=1 to get the implementation from
+ * this header instead of http_parser.cpp, so that execute() and its tables
+ * can be inlined into, and specialized for, the calling code.
+ */
+#ifndef HTTP_PARSER_HEADER_ONLY
+# define HTTP_PARSER_HEADER_ONLY 0
+#endif
+
+#if HTTP_PARSER_HEADER_ONLY
+# define HTTP_PARSER_INLINE inline
+#else
+# define HTTP_PARSER_INLINE
+#endif
+
+/* Whether the compiler supports labels as values, which the threaded
+ * parsing policies need; without them they fall back to the switch.
+ */
+#ifndef HTTP_PARSER_COMPUTED_GOTO
+# if defined(__GNUC__) || defined(__clang__)
+#  define HTTP_PARSER_COMPUTED_GOTO 1
+# else
+#  define HTTP_PARSER_COMPUTED_GOTO 0
+# endif
+#endif
+
 /* Maximium header size allowed */
 #define HTTP_MAX_HEADER_SIZE (80*1024)
 
+/* Maximum size of a chunk-size line, extensions included */
+#ifndef HTTP_MAX_CHUNK_EXTENSION_SIZE
+# define HTTP_MAX_CHUNK_EXTENSION_SIZE (16*1024)
+#endif
+
 /* Map for errno-related constants
  *
  * The provided argument should be a macro that takes 2 arguments.
@@ -78,6 +113,10 @@ typedef int ssize_t;
   XX(CB_reason, "the on_reason callback failed")                     \
   XX(CB_chunk_header, "the on_chunk_header callback failed")         \
   XX(CB_chunk_complete, "the on_chunk_complete callback failed")     \
+  XX(CB_chunk_extension, "the on_chunk_extension callback failed")   \
+  XX(CB_trailer_field, "the on_trailer_field callback failed")       \
+  XX(CB_trailer_value, "the on_trailer_value callback failed")       \
+  XX(CB_trailers_complete, "the on_trailers_complete callback failed") \
                                                                      \
   /* Parsing-related errors */                                       \
   XX(INVALID_EOF_STATE, "stream ended at an unexpected time")        \
@@ -98,12 +137,16 @@ typedef int ssize_t;
   XX(INVALID_HEADER_TOKEN, "invalid character in header")            \
   XX(INVALID_CONTENT_LENGTH,                                         \
      "invalid character in content-length header")                   \
+  XX(INVALID_TRANSFER_ENCODING,                                      \
+     "invalid transfer-encoding coding list")                        \
   XX(HUGE_CONTENT_LENGTH,                                            \
      "content-length header too large")                              \
   XX(INVALID_CHUNK_SIZE,                                             \
      "invalid character in chunk size header")                       \
   XX(HUGE_CHUNK_SIZE,                                                \
      "chunk header size too large")                                  \
+  XX(CHUNK_EXTENSION_OVERFLOW,                                       \
+     "too many chunk extension bytes seen")                          \
   XX(INVALID_CONSTANT, "invalid constant string")                    \
   XX(INVALID_INTERNAL_STATE, "encountered unexpected internal state")\
   XX(STRICT, "strict mode assertion failed")                         \
@@ -195,11 +238,24 @@ public:
 	/* Flag values for http_parser.flags field */
 	enum flags
 	{ F_CHUNKED               = 1 << 0
+	, F_BYPASSBODY            = 1 << 1
 	, F_TRAILING              = 1 << 3
 	, F_UPGRADE               = 1 << 4
 	, F_SKIPBODY              = 1 << 5
 	};
 
+	/* Transfer codings seen in the Transfer-Encoding header(s) of the
+	 * current message; see transfer_encoding().
+	 */
+	enum transfer_codings
+	{ TE_CHUNKED              = 1 << 0
+	, TE_GZIP                 = 1 << 1
+	, TE_DEFLATE              = 1 << 2
+	, TE_BR                   = 1 << 3
+	, TE_IDENTITY             = 1 << 4
+	, TE_OTHER                = 1 << 5  /* any coding not listed above */
+	};
+
 	struct http_errno
 	{
 		http_errno(int e) : m_errno((http_errno_enum)e){}
@@ -226,6 +282,12 @@ public:
 	 * HEAD request which may contain 'Content-Length' or 'Transfer-Encoding:
 	 * chunked' headers that indicate the presence of a body.
 	 *
+	 * Returning '2' from on_headers_complete hands a Content-Length body
+	 * to the caller: execute() returns right after the headers and the
+	 * caller reads, splices or forwards the next bypass_length() bytes
+	 * itself, reporting them with consume_body(). Bodies that are chunked
+	 * or delimited by EOF are parsed as if '0' had been returned.
+	 *
 	 * http_data_cb does not return data chunks. It will be call arbitrarally
 	 * many times for each string. E.G. you might get 10 callbacks for "on_path"
 	 * each providing just a few characters more data.
@@ -248,6 +310,19 @@ public:
 		*/
 		http_cb      on_chunk_header;
 		http_cb      on_chunk_complete;
+		/* Optional. Receives the raw chunk-ext of each chunk-size line, i.e.
+		* the ";name[=value]" list up to but not including the CR. It is
+		* called before on_chunk_header for the same chunk.
+		*/
+		http_data_cb on_chunk_extension;
+		/* Optional. Trailer fields of chunked messages are delivered here
+		* instead of on_header_field/on_header_value when these are set.
+		* on_trailers_complete runs once the trailer section (possibly
+		* empty) has ended, before the last on_chunk_complete.
+		*/
+		http_data_cb on_trailer_field;
+		http_data_cb on_trailer_value;
+		http_cb      on_trailers_complete;
 	};
 
 
@@ -255,13 +330,104 @@ public:
 
 	http_parser(enum http_parser_type t);
 
+	/* Reinitialize the parser for a new connection, exactly as the
+	* constructor does. Cheaper than constructing a new parser.
+	*/
+	void reset(enum http_parser_type t);
+
 public:
 
 	std::size_t execute(const parser_settings& _settings, const char *data, size_t len);
 
+	/* Same, with an explicit parsing policy (see http_parser_policy below)
+	 * instead of the HTTP_PARSER_STRICT default.
+	 *
+	 * SETTINGS may also be a type of its own with the members of
+	 * parser_settings, e.g. static member functions, so that the callbacks
+	 * are known at compile time. Such types need HTTP_PARSER_HEADER_ONLY;
+	 * the library only instantiates parser_settings.
+	 */
+	template <class Policy, class Settings>
+	std::size_t execute(const Settings& _settings, const char *data, size_t len);
+
+	/* Like execute(), but chunked bodies are decoded in place: chunk
+	 * payloads are moved down over the chunk-size lines and CRLFs of DATA
+	 * and passed to on_body as one contiguous span per call (and per
+	 * message). on_chunk_header, on_chunk_complete and on_chunk_extension
+	 * are not called. Bytes of DATA that were already parsed may be
+	 * overwritten. If parsing fails, the payload compacted before the
+	 * error is passed to on_body before the call returns.
+	 */
+	std::size_t execute_dechunk(const parser_settings& _settings, char *data, size_t len);
+
+	template <class Policy, class Settings>
+	std::size_t execute_dechunk(const Settings& _settings, char *data, size_t len);
+
 	/* Pause or un-pause the parser; a nonzero value pauses */
 	void pause(int paused);
 
+	/* Body bytes left for the caller after on_headers_complete returned 2;
+	 * 0 when no body is being bypassed.
+	 */
+	uint64_t bypass_length();
+
+	/* True if the data of the on_body call in progress is the last of
+	* the body; never for chunked bodies or bodies read until EOF.
+	*/
+	bool body_is_final();
+
+	/* Report N bypassed body bytes as consumed. Runs on_message_complete
+	 * once the whole body is accounted for, after which execute() resumes
+	 * at the next message, or, if has_upgrade(), the connection has
+	 * switched protocols as when execute() returns at an upgrade. Body
+	 * bytes may also still be given to execute(), which delivers them
+	 * through on_body. Returns the resulting errno; the parser is left
+	 * unchanged and HPE_INVALID_INTERNAL_STATE returned if no body is
+	 * being bypassed or N is more than bypass_length().
+	 */
+	int consume_body(const parser_settings& settings, uint64_t n);
+
+	/* Same, with SETTINGS of another type as for execute() */
+	template <class Settings>
+	int consume_body(const Settings& settings, uint64_t n);
+
+	/* Everything a parser needs to resume between two execute() calls,
+	* for moving a connection to another thread or process. Plain data of
+	* a fixed size in host byte order; import_state() rejects a state from
+	* a different VERSION.
+	*/
+	struct exported_state {
+		static constexpr uint32_t current_version = 1;
+
+		uint32_t version;
+		uint32_t nread;
+		int64_t content_length;
+		uint16_t status_code;
+		uint16_t http_major;
+		uint16_t http_minor;
+		uint8_t state;
+		uint8_t header_state;
+		uint8_t index;
+		uint8_t flags;
+		uint8_t type;
+		uint8_t method;
+		uint8_t transfer_encoding;
+		uint8_t http_errno;
+		uint8_t upgrade;
+		uint8_t reserved;
+	};
+
+	void export_state(exported_state& s) const;
+
+	/* Continue from a state written by export_state(); the callbacks and
+	* the parsing policy are those of the following execute() calls.
+	* Returns HPE_INVALID_INTERNAL_STATE, leaving the parser unchanged, if
+	* S comes from another version or is not a state export_state() can
+	* write (a field out of range or inconsistent with the others), else
+	* HPE_OK.
+	*/
+	int import_state(const exported_state& s);
+
 public:
 
 	/* Returns a string version of the HTTP method. */
@@ -269,19 +435,24 @@ public:
 
 private:
 
-	unsigned char type : 2;     /* enum http_parser_type */
-	unsigned char flags : 6;    /* F_* values from 'flags' enum; semi-public */
-	unsigned char state;        /* enum state from http_parser.c */
-	unsigned char header_state; /* enum header_state from http_parser.c */
+	/* Largest members first, so the layout has no padding; the fields that
+	* execute() touches for every byte share the first 16 bytes. See the
+	* static_assert below the class before adding anything here.
+	*/
+	int64_t m_content_length;  /* # bytes in body (0 if no Content-Length header) */
+	uint32_t nread;            /* # bytes read in various scenarios */
+	unsigned char state;        /* enum state from http_parser.cpp */
+	unsigned char header_state; /* enum header_state from http_parser.cpp */
 	unsigned char index;        /* index into current matcher */
+	unsigned char flags;        /* F_* values from 'flags' enum; semi-public */
 
-	uint32_t nread;          /* # bytes read in various scenarios */
-	int64_t m_content_length;  /* # bytes in body (0 if no Content-Length header) */
+	uint32_t m_status_code : 10; /* responses only */
+	uint32_t m_http_major : 10;
+	uint32_t m_http_minor : 10;
+	uint32_t type : 2;          /* enum http_parser_type */
 
-	unsigned short m_http_major;
-	unsigned short m_http_minor;
-	unsigned short m_status_code; /* responses only */
 	unsigned char m_method;       /* requests only */
+	unsigned char m_transfer_encoding; /* TE_* values from 'transfer_codings' enum */
 	unsigned char m_http_errno : 7;
 
 	/* 1 = Upgrade header was present and the parser has exited because of that.
@@ -289,7 +460,10 @@ private:
 	* Should be checked when http_parser_execute() returns in addition to
 	* error checking.
 	*/
-	char m_upgrade : 1;
+	unsigned char m_upgrade : 1;
+
+	template <class Policy, class Settings>
+	std::size_t execute(const Settings& settings, const char *data, size_t len, char *dechunk);
 
 public:
 	/* Get an http_errno value from an http_parser */
@@ -300,10 +474,180 @@ public:
  	inline unsigned short http_major(){return m_http_major;}
  	inline unsigned short http_minor(){return m_http_minor;}
 
- 	inline unsigned short set_status_code(unsigned short _status_code){m_status_code = _status_code;}
+ 	inline unsigned short status_code(){return m_status_code;}
+	/* Status codes have three digits, as m_status_code has 10 bits; a
+	* larger value is not stored and the status code stays as it was.
+	*/
+ 	inline unsigned short set_status_code(unsigned short _status_code){
+ 		assert(_status_code <= 999);
+ 		if (_status_code <= 999) m_status_code = _status_code;
+ 		return m_status_code;
+ 	}
 
  	inline unsigned char request_method(){return m_method;}
 
  	inline int64_t content_length(){return m_content_length;}
+
+	/* True while the trailer section of a chunked message is parsed */
+ 	inline bool in_trailers(){return flags & F_TRAILING;}
+
+	/* TE_* bitmask of the codings listed in Transfer-Encoding. When
+	* TE_CHUNKED is set, chunked was the final coding and the body is
+	* framed by chunks; the other bits describe codings the application
+	* still has to undo.
+	*/
+ 	inline unsigned char transfer_encoding(){return m_transfer_encoding;}
+};
+
+/* One parser is kept per connection, so its size is part of the API */
+static_assert(sizeof(http_parser) <= 24, "http_parser grew beyond 24 bytes");
+
+static_assert(sizeof(http_parser::exported_state) == 32 &&
+              std::is_trivially_copyable<http_parser::exported_state>::value,
+              "http_parser::exported_state must stay a fixed-size POD");
+
+/* Parsing policies, resolved at compile time.
+ *
+ * The strict policy rejects tabs and form feeds in URLs, bytes with the
+ * high bit set in URLs, underscores in hostnames, and fails with
+ * HPE_STRICT on a malformed "HTTP/" prefix or a bare CR where CRLF is
+ * expected. The lenient policy accepts all of these.
+ *
+ * TYPE narrows a policy to requests or responses: the states of the other
+ * message type and of HTTP_BOTH detection are compiled out, and the parser
+ * must have been constructed for that type.
+ *
+ * THREADED selects a direct-threaded state machine: each state jumps
+ * straight to the code of the next one through a table of label
+ * addresses instead of going back through the switch. It needs
+ * HTTP_PARSER_COMPUTED_GOTO and parses exactly like the switch otherwise.
+ */
+template <bool Strict, http_parser::http_parser_type Type = http_parser::HTTP_BOTH,
+          bool Threaded = false>
+struct http_parser_policy
+{
+	static constexpr bool strict = Strict;
+	static constexpr http_parser::http_parser_type type = Type;
+	static constexpr bool threaded = Threaded && HTTP_PARSER_COMPUTED_GOTO;
 };
 
+typedef http_parser_policy<true> http_parser_strict;
+typedef http_parser_policy<false> http_parser_lenient;
+typedef http_parser_policy<HTTP_PARSER_STRICT != 0> http_parser_default_policy;
+
+typedef http_parser_policy<HTTP_PARSER_STRICT != 0, http_parser::HTTP_REQUEST> http_parser_request_only;
+typedef http_parser_policy<HTTP_PARSER_STRICT != 0, http_parser::HTTP_RESPONSE> http_parser_response_only;
+typedef http_parser_policy<HTTP_PARSER_STRICT != 0, http_parser::HTTP_BOTH, true> http_parser_threaded;
+
+/* http_parser_parse_url() with an explicit parsing policy */
+template <class Policy>
+int http_parser_parse_url(const char *buf, size_t buflen, int is_connect, struct http_parser_url *u);
+
+/* Slab allocator for parsers, for accept loops with high connection churn.
+ *
+ * Parsers are carved out of slabs of SLAB_SIZE objects and recycled through
+ * a LIFO free list, so a new connection usually gets the parser that was
+ * released last and is still in cache. Memory is returned to the system
+ * only when the pool is destroyed.
+ *
+ * A pool is not thread safe. thread_local_pool() returns a pool private to
+ * the calling thread; parsers must be released to the pool that handed them
+ * out, on the thread that owns it.
+ */
+class http_parser_pool
+{
+public:
+	explicit http_parser_pool(size_t slab_size = 1024);
+	~http_parser_pool();
+
+	http_parser_pool(const http_parser_pool&) = delete;
+	http_parser_pool& operator=(const http_parser_pool&) = delete;
+
+	/* Returns a parser constructed for type T */
+	http_parser* acquire(http_parser::http_parser_type t);
+
+	void release(http_parser *p);
+
+	static http_parser_pool& thread_local_pool();
+
+private:
+	union node {
+		node *next;
+		alignas(http_parser) unsigned char storage[sizeof(http_parser)];
+	};
+
+	size_t m_slab_size;
+	node *m_free;
+	std::vector<node *> m_slabs;
+};
+
+/* Bump-pointer arena for copying the header fields and values of one
+ * message, for callers that need them after the input buffer is reused.
+ *
+ * Fragments passed to append_field()/append_value() are joined into
+ * contiguous strings, following the rules of the README's header table.
+ * Memory comes from the caller's buffer if one is given, then from heap
+ * blocks of BLOCK_SIZE bytes. reset() forgets the headers but keeps all
+ * memory, so once warmed up a keep-alive connection parses its requests
+ * without touching malloc.
+ *
+ * bind() installs on_header_field/on_header_value callbacks that feed the
+ * arena and makes on_message_begin/on_message_complete reset it, after
+ * running the callbacks that were set before. Headers are thus valid from
+ * on_headers_complete until on_message_complete returns.
+ */
+class http_header_arena
+{
+public:
+	struct header {
+		const char *field;
+		size_t field_len;
+		const char *value;
+		size_t value_len;
+	};
+
+	explicit http_header_arena(size_t block_size = 4096);
+	http_header_arena(char *buf, size_t size, size_t block_size = 4096);
+	~http_header_arena();
+
+	http_header_arena(const http_header_arena&) = delete;
+	http_header_arena& operator=(const http_header_arena&) = delete;
+
+	/* Return 0, or -1 when out of memory, so that they can be returned
+	 * from parser callbacks as is.
+	 */
+	int append_field(const char *at, size_t length);
+	int append_value(const char *at, size_t length);
+
+	void reset();
+
+	void bind(http_parser::parser_settings& settings);
+
+	size_t size() const { return m_headers.size(); }
+	const header& operator[](size_t i) const { return m_headers[i]; }
+
+	/* First header named NAME (case-insensitive), or null */
+	const header* find(const char *name) const;
+
+private:
+	struct block {
+		char *data;
+		size_t size;
+		bool owned;
+	};
+
+	int append(const char *at, size_t length);
+
+	std::vector<block> m_blocks;
+	std::vector<header> m_headers;
+	size_t m_block_size;
+	size_t m_current;    /* index into m_blocks */
+	size_t m_used;       /* bytes used in m_blocks[m_current] */
+	char *m_str;         /* string being appended to */
+	size_t m_str_len;
+	enum { NONE, FIELD, VALUE } m_last;
+};
+
+#if HTTP_PARSER_HEADER_ONLY
+# include "http_parser.ipp"
+#endif
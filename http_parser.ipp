@@ -0,0 +1,3477 @@
+/* Based on src/http/ngx_http_parse.c from NGINX copyright Igor Sysoev
+ *
+ * Additional changes are licensed under the same terms as NGINX and
+ * copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Implementation of http_parser.hpp. It is compiled by http_parser.cpp, or
+ * included by http_parser.hpp itself when HTTP_PARSER_HEADER_ONLY is set.
+ * Internal names live in http_parser_detail; the macros are undefined at
+ * the end of this file.
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "http_parser.hpp"
+
+// #ifndef INT64_MAX
+// # define INT64_MAX std::numeric_limits<int64_t>::max()
+// #endif
+
+#if HTTP_PARSER_DEBUG
+#define SET_ERRNO(e)                                                 \
+do {                                                                 \
+  this->http_errno = (e);                                          \
+  this->error_lineno = __LINE__;                                   \
+} while (0)
+#else
+#define SET_ERRNO(e)                                                 \
+do {                                                                 \
+  this->m_http_errno = (e);                                          \
+} while(0)
+#endif
+
+#define RETURN(r)                                                    \
+do {                                                                 \
+  this->state = state;                                             \
+  return (r);                                                        \
+} while(0)
+
+/* Run the notify callback FOR, returning ER if it fails */
+#define _CALLBACK_NOTIFY(FOR, ER)                                    \
+do {                                                                 \
+  this->state = state;                                             \
+  assert(m_http_errno == HPE_OK);                       \
+                                                                     \
+  if (0 != settings.on_##FOR(*this)) {                             \
+    SET_ERRNO(HPE_CB_##FOR);                                         \
+  }                                                                  \
+                                                                     \
+  /* We either errored above or got paused; get out */               \
+  if (m_http_errno != HPE_OK) {                         \
+    return (ER);                                                     \
+  }                                                                  \
+} while (0)
+
+/* Run the notify callback FOR and consume the current byte */
+#define CALLBACK_NOTIFY(FOR)            _CALLBACK_NOTIFY(FOR, p - data + 1)
+
+/* Run the notify callback FOR and don't consume the current byte */
+#define CALLBACK_NOTIFY_NOADVANCE(FOR)  _CALLBACK_NOTIFY(FOR, p - data)
+
+/* Run data callback CB on the FOR mark with LEN bytes, returning ER if it
+ * fails */
+#define _CALLBACK_DATA_AS(FOR, CB, LEN, ER)                          \
+do {                                                                 \
+  this->state = state;                                             \
+  assert(m_http_errno == HPE_OK);                       \
+                                                                     \
+  if (FOR##_mark) {                                                  \
+    if (0 != settings.on_##CB(*this, FOR##_mark, (LEN))) {         \
+      SET_ERRNO(HPE_CB_##CB);                                        \
+    }                                                                \
+                                                                     \
+    /* We either errored above or got paused; get out */             \
+    if (m_http_errno != HPE_OK) {                       \
+      return (ER);                                                   \
+    }                                                                \
+    FOR##_mark = nullptr;                                               \
+  }                                                                  \
+} while (0)
+
+/* Run data callback FOR with LEN bytes, returning ER if it fails */
+#define _CALLBACK_DATA(FOR, LEN, ER) _CALLBACK_DATA_AS(FOR, FOR, LEN, ER)
+
+/* Run the data callback FOR and consume the current byte */
+#define CALLBACK_DATA(FOR)                                           \
+    _CALLBACK_DATA(FOR, p - FOR##_mark, p - data + 1)
+
+/* Run the data callback FOR and don't consume the current byte */
+#define CALLBACK_DATA_NOADVANCE(FOR)                                 \
+    _CALLBACK_DATA(FOR, p - FOR##_mark, p - data)
+
+/* We just saw a synthetic space */
+#define CALLBACK_SPACE(FOR)                                          \
+do {                                                                 \
+  this->state = state;                                             \
+  if (0 != settings.on_##FOR(*this, SPACE, 1)) {                   \
+    SET_ERRNO(HPE_CB_##FOR);                                         \
+    return (p - data);                                               \
+  }                                                                  \
+                                                                     \
+  /* We either errored above or got paused; get out */               \
+  if (m_http_errno != HPE_OK) {                                      \
+    return (p - data);                                               \
+  }                                                                  \
+} while (0)
+
+/* While parsing trailers, header data goes to the on_trailer_* callbacks
+ * if they are set, and to on_header_* otherwise.
+ */
+#define IS_TRAILER_CB(FOR) ((flags & F_TRAILING) && callback_set(settings.on_trailer_##FOR))
+
+#define _CALLBACK_HEADER(FOR, ER)                                    \
+do {                                                                 \
+  if (IS_TRAILER_CB(FOR)) {                                          \
+    _CALLBACK_DATA_AS(header_##FOR, trailer_##FOR,                   \
+                      p - header_##FOR##_mark, ER);                  \
+  } else {                                                           \
+    _CALLBACK_DATA(header_##FOR, p - header_##FOR##_mark, ER);       \
+  }                                                                  \
+} while (0)
+
+#define CALLBACK_HEADER(FOR)            _CALLBACK_HEADER(FOR, p - data + 1)
+#define CALLBACK_HEADER_NOADVANCE(FOR)  _CALLBACK_HEADER(FOR, p - data)
+
+#define CALLBACK_HEADER_SPACE(FOR)                                   \
+do {                                                                 \
+  if (IS_TRAILER_CB(FOR)) {                                          \
+    CALLBACK_SPACE(trailer_##FOR);                                   \
+  } else {                                                           \
+    CALLBACK_SPACE(header_##FOR);                                    \
+  }                                                                  \
+} while (0)
+
+/* Deliver the chunk payloads compacted so far in dechunk mode */
+#define CALLBACK_DECHUNKED(ER)                                       \
+do {                                                                 \
+  if (dechunked_len) {                                               \
+    this->state = state;                                           \
+    if (0 != settings.on_body(*this, dechunked, dechunked_len)) {  \
+      SET_ERRNO(HPE_CB_body);                                        \
+    }                                                                \
+    dechunked = nullptr;                                             \
+    dechunked_len = 0;                                               \
+                                                                     \
+    if (m_http_errno != HPE_OK) {                                    \
+      return (ER);                                                   \
+    }                                                                \
+  }                                                                  \
+} while (0)
+
+/* Chunk framing callbacks are not run in dechunk mode */
+#define CALLBACK_CHUNK_NOTIFY(FOR)                                   \
+do {                                                                 \
+  if (!dechunk) {                                                    \
+    CALLBACK_NOTIFY(FOR);                                            \
+  }                                                                  \
+} while (0)
+
+/* Set the mark FOR; non-destructive if mark is already set */
+#define MARK(FOR)                                                    \
+do {                                                                 \
+  if (!FOR##_mark) {                                                 \
+    FOR##_mark = p;                                                  \
+  }                                                                  \
+} while (0)
+
+
+#define CONTENT_LENGTH "content-length"
+#define TRANSFER_ENCODING "transfer-encoding"
+#define UPGRADE "upgrade"
+#define CHUNKED "chunked"
+#define GZIP "gzip"
+#define DEFLATE "deflate"
+#define BR "br"
+#define IDENTITY "identity"
+#define SPACE " "
+
+
+namespace http_parser_detail {
+
+/* Whether an optional callback is set. std::function and function pointers
+ * may be empty; any other callable in a compile-time settings type, such as
+ * a static member function, is set. A function is never converted to a
+ * pointer to test it, which GCC would warn is always true.
+ */
+template <class F>
+constexpr bool callback_set(const F& f)
+{
+  if constexpr (std::is_function<F>::value) {
+    return true;
+  } else if constexpr (std::is_pointer<F>::value ||
+                       std::is_member_function_pointer<F>::value) {
+    return f != nullptr;
+  } else if constexpr (std::is_constructible<bool, const F&>::value) {
+    return static_cast<bool>(f);
+  } else {
+    return true;
+  }
+}
+
+inline constexpr const char *method_strings[] =
+  { "DELETE"
+  , "GET"
+  , "HEAD"
+  , "POST"
+  , "PUT"
+  , "CONNECT"
+  , "OPTIONS"
+  , "TRACE"
+  , "COPY"
+  , "LOCK"
+  , "MKCOL"
+  , "MOVE"
+  , "PROPFIND"
+  , "PROPPATCH"
+  , "UNLOCK"
+  , "REPORT"
+  , "MKACTIVITY"
+  , "CHECKOUT"
+  , "MERGE"
+  , "M-SEARCH"
+  , "NOTIFY"
+  , "SUBSCRIBE"
+  , "UNSUBSCRIBE"
+  , "PATCH"
+  };
+
+
+/* Tokens as defined by rfc 2616. Also lowercases them.
+ *        token       = 1*<any CHAR except CTLs or separators>
+ *     separators     = "(" | ")" | "<" | ">" | "@"
+ *                    | "," | ";" | ":" | "\" | <">
+ *                    | "/" | "[" | "]" | "?" | "="
+ *                    | "{" | "}" | SP | HT
+ */
+inline constexpr char tokens[256] = {
+/*   0 nul    1 soh    2 stx    3 etx    4 eot    5 enq    6 ack    7 bel  */
+        0,       0,       0,       0,       0,       0,       0,       0,
+/*   8 bs     9 ht    10 nl    11 vt    12 np    13 cr    14 so    15 si   */
+        0,       0,       0,       0,       0,       0,       0,       0,
+/*  16 dle   17 dc1   18 dc2   19 dc3   20 dc4   21 nak   22 syn   23 etb */
+        0,       0,       0,       0,       0,       0,       0,       0,
+/*  24 can   25 em    26 sub   27 esc   28 fs    29 gs    30 rs    31 us  */
+        0,       0,       0,       0,       0,       0,       0,       0,
+/*  32 sp    33  !    34  "    35  #    36  $    37  %    38  &    39  '  */
+       ' ',      '!',     '"',     '#',     '$',     '%',     '&',    '\'',
+/*  40  (    41  )    42  *    43  +    44  ,    45  -    46  .    47  /  */
+        0,       0,      '*',     '+',      0,      '-',     '.',     '/',
+/*  48  0    49  1    50  2    51  3    52  4    53  5    54  6    55  7  */
+       '0',     '1',     '2',     '3',     '4',     '5',     '6',     '7',
+/*  56  8    57  9    58  :    59  ;    60  <    61  =    62  >    63  ?  */
+       '8',     '9',      0,       0,       0,       0,       0,       0,
+/*  64  @    65  A    66  B    67  C    68  D    69  E    70  F    71  G  */
+        0,      'a',     'b',     'c',     'd',     'e',     'f',     'g',
+/*  72  H    73  I    74  J    75  K    76  L    77  M    78  N    79  O  */
+       'h',     'i',     'j',     'k',     'l',     'm',     'n',     'o',
+/*  80  P    81  Q    82  R    83  S    84  T    85  U    86  V    87  W  */
+       'p',     'q',     'r',     's',     't',     'u',     'v',     'w',
+/*  88  X    89  Y    90  Z    91  [    92  \    93  ]    94  ^    95  _  */
+       'x',     'y',     'z',      0,       0,       0,      '^',     '_',
+/*  96  `    97  a    98  b    99  c   100  d   101  e   102  f   103  g  */
+       '`',     'a',     'b',     'c',     'd',     'e',     'f',     'g',
+/* 104  h   105  i   106  j   107  k   108  l   109  m   110  n   111  o  */
+       'h',     'i',     'j',     'k',     'l',     'm',     'n',     'o',
+/* 112  p   113  q   114  r   115  s   116  t   117  u   118  v   119  w  */
+       'p',     'q',     'r',     's',     't',     'u',     'v',     'w',
+/* 120  x   121  y   122  z   123  {   124  |   125  }   126  ~   127 del */
+       'x',     'y',     'z',      0,      '|',     '}',     '~',       0 };
+
+
+inline constexpr int8_t unhex[256] =
+  {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  , 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,-1,-1,-1,-1,-1,-1
+  ,-1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  };
+
+/* URL characters accepted by both parsing policies; the lenient policy
+ * adds the T(1) entries and bytes with the high bit set (see char_class()).
+ */
+#define T(v) 0
+
+inline constexpr uint8_t normal_url_char[256] = {
+/*   0 nul    1 soh    2 stx    3 etx    4 eot    5 enq    6 ack    7 bel  */
+        0,       0,       0,       0,       0,       0,       0,       0,
+/*   8 bs     9 ht    10 nl    11 vt    12 np    13 cr    14 so    15 si   */
+        0,     T(1),      0,       0,     T(1),      0,       0,       0,
+/*  16 dle   17 dc1   18 dc2   19 dc3   20 dc4   21 nak   22 syn   23 etb */
+        0,       0,       0,       0,       0,       0,       0,       0,
+/*  24 can   25 em    26 sub   27 esc   28 fs    29 gs    30 rs    31 us  */
+        0,       0,       0,       0,       0,       0,       0,       0,
+/*  32 sp    33  !    34  "    35  #    36  $    37  %    38  &    39  '  */
+        0,       1,       1,       0,       1,       1,       1,       1,
+/*  40  (    41  )    42  *    43  +    44  ,    45  -    46  .    47  /  */
+        1,       1,       1,       1,       1,       1,       1,       1,
+/*  48  0    49  1    50  2    51  3    52  4    53  5    54  6    55  7  */
+        1,       1,       1,       1,       1,       1,       1,       1,
+/*  56  8    57  9    58  :    59  ;    60  <    61  =    62  >    63  ?  */
+        1,       1,       1,       1,       1,       1,       1,       0,
+/*  64  @    65  A    66  B    67  C    68  D    69  E    70  F    71  G  */
+        1,       1,       1,       1,       1,       1,       1,       1,
+/*  72  H    73  I    74  J    75  K    76  L    77  M    78  N    79  O  */
+        1,       1,       1,       1,       1,       1,       1,       1,
+/*  80  P    81  Q    82  R    83  S    84  T    85  U    86  V    87  W  */
+        1,       1,       1,       1,       1,       1,       1,       1,
+/*  88  X    89  Y    90  Z    91  [    92  \    93  ]    94  ^    95  _  */
+        1,       1,       1,       1,       1,       1,       1,       1,
+/*  96  `    97  a    98  b    99  c   100  d   101  e   102  f   103  g  */
+        1,       1,       1,       1,       1,       1,       1,       1,
+/* 104  h   105  i   106  j   107  k   108  l   109  m   110  n   111  o  */
+        1,       1,       1,       1,       1,       1,       1,       1,
+/* 112  p   113  q   114  r   115  s   116  t   117  u   118  v   119  w  */
+        1,       1,       1,       1,       1,       1,       1,       1,
+/* 120  x   121  y   122  z   123  {   124  |   125  }   126  ~   127 del */
+        1,       1,       1,       1,       1,       1,       1,       0, };
+
+#undef T
+
+/* The values of enum state and enum header_states are part of
+ * http_parser::exported_state; bump its current_version when they change.
+ */
+enum state
+  { s_dead = 1 /* important that this is > 0 */
+  , s_pre_start_req_or_res
+  , s_start_req_or_res
+  , s_res_or_resp_H
+
+  , s_pre_start_res
+  , s_start_res
+  , s_res_H
+  , s_res_HT
+  , s_res_HTT
+  , s_res_HTTP
+  , s_res_first_http_major
+  , s_res_http_major
+  , s_res_first_http_minor
+  , s_res_http_minor
+  , s_res_first_status_code
+  , s_res_status_code
+  , s_res_status_start
+  , s_res_status
+  , s_res_line_almost_done
+
+  , s_pre_start_req
+  , s_start_req
+  , s_req_method
+  , s_req_spaces_before_url
+  , s_req_schema
+  , s_req_schema_slash
+  , s_req_schema_slash_slash
+  , s_req_server_start
+  , s_req_server
+  , s_req_server_with_at
+  , s_req_host_start
+  , s_req_host
+  , s_req_host_ipv6
+  , s_req_host_done
+  , s_req_port
+  , s_req_path
+  , s_req_query_string_start
+  , s_req_query_string
+  , s_req_fragment_start
+  , s_req_fragment
+  , s_req_http_start
+  , s_req_http_H
+  , s_req_http_HT
+  , s_req_http_HTT
+  , s_req_http_HTTP
+  , s_req_first_http_major
+  , s_req_http_major
+  , s_req_first_http_minor
+  , s_req_http_minor
+  , s_req_line_almost_done
+
+  , s_header_field_start
+  , s_header_field
+  , s_header_value_start
+  , s_header_value
+  , s_header_value_lws
+
+  , s_header_almost_done
+
+  , s_chunk_size_start
+  , s_chunk_size
+  , s_chunk_parameters
+  , s_chunk_extensions
+  , s_chunk_size_almost_done
+
+  , s_headers_almost_done
+  , s_trailers_done
+  , s_headers_done
+
+  , s_chunk_data
+  , s_chunk_data_almost_done
+  , s_chunk_data_done
+
+  , s_body_identity
+  , s_body_identity_eof
+
+  , s_message_done
+  };
+
+
+/* Per-state attributes, so that execute() can classify its state with a
+ * single table load instead of comparing it against lists of states.
+ */
+enum state_attributes
+  { A_MARK              = 0x07  /* mask: mark to restore when resuming */
+  , A_HEADER            = 0x08  /* bytes count against HTTP_MAX_HEADER_SIZE */
+  , A_URL               = 0x10  /* inside the request-target */
+  , A_NEEDS_DATA        = 0x20  /* EOF in this state is an error */
+  , A_CHUNK_LINE        = 0x40  /* bytes count against HTTP_MAX_CHUNK_EXTENSION_SIZE */
+  };
+
+enum state_marks
+  { MARK_NONE = 0
+  , MARK_URL
+  , MARK_HEADER_FIELD
+  , MARK_HEADER_VALUE
+  , MARK_REASON
+  , MARK_CHUNK_EXTENSION
+  };
+
+constexpr unsigned char
+state_attributes(int s)
+{
+  switch (s) {
+    case s_pre_start_req_or_res:
+    case s_pre_start_res:
+    case s_pre_start_req:
+      return A_HEADER;
+
+    case s_body_identity_eof:
+      return 0;
+
+    case s_req_schema:
+    case s_req_schema_slash:
+    case s_req_schema_slash_slash:
+    case s_req_server_start:
+    case s_req_server:
+    case s_req_server_with_at:
+    case s_req_host_start:
+    case s_req_host:
+    case s_req_host_ipv6:
+    case s_req_host_done:
+    case s_req_port:
+    case s_req_path:
+    case s_req_query_string_start:
+    case s_req_query_string:
+    case s_req_fragment_start:
+    case s_req_fragment:
+      return A_HEADER | A_NEEDS_DATA | A_URL | MARK_URL;
+
+    case s_res_status:
+      return A_HEADER | A_NEEDS_DATA | MARK_REASON;
+
+    case s_header_field:
+      return A_HEADER | A_NEEDS_DATA | MARK_HEADER_FIELD;
+
+    case s_header_value:
+      return A_HEADER | A_NEEDS_DATA | MARK_HEADER_VALUE;
+
+    case s_chunk_size_start:
+    case s_chunk_size:
+    case s_chunk_parameters:
+    case s_chunk_size_almost_done:
+      return A_HEADER | A_NEEDS_DATA | A_CHUNK_LINE;
+
+    case s_chunk_extensions:
+      return A_HEADER | A_NEEDS_DATA | A_CHUNK_LINE | MARK_CHUNK_EXTENSION;
+
+    case s_chunk_data:
+    case s_chunk_data_almost_done:
+    case s_chunk_data_done:
+    case s_body_identity:
+    case s_message_done:
+      return A_NEEDS_DATA;
+
+    default:
+      return A_HEADER | A_NEEDS_DATA;
+  }
+}
+
+struct state_table {
+  unsigned char attributes[s_message_done + 1];
+
+  constexpr state_table() : attributes() {
+    for (int s = 0; s <= s_message_done; s++) {
+      attributes[s] = state_attributes(s);
+    }
+  }
+};
+
+inline constexpr state_table state_attrs {};
+
+#define STATE_ATTRIBUTES(state) (state_attrs.attributes[state])
+#define PARSING_HEADER(state) (STATE_ATTRIBUTES(state) & A_HEADER)
+#define PARSING_CHUNK_LINE(state) (STATE_ATTRIBUTES(state) & A_CHUNK_LINE)
+
+
+enum header_states
+  { h_general = 0
+
+  , h_general_and_quote
+  , h_general_and_quote_and_escape
+
+  , h_matching_content_length
+  , h_matching_transfer_encoding
+  , h_matching_upgrade
+
+  , h_content_length
+  , h_transfer_encoding
+  , h_upgrade
+
+  /* Transfer-Encoding coding list. h_transfer_encoding is used between
+   * codings; the h_matching_te_* states must stay in te_codings[] order.
+   */
+  , h_transfer_encoding_token
+  , h_transfer_encoding_params
+  , h_transfer_encoding_params_quote
+  , h_transfer_encoding_params_quote_escape
+  , h_matching_te_chunked
+  , h_matching_te_gzip
+  , h_matching_te_deflate
+  , h_matching_te_br
+  , h_matching_te_identity
+  };
+
+struct te_coding {
+  const char *name;
+  unsigned char coding;
+};
+
+inline constexpr te_coding te_codings[] =
+  { { CHUNKED, http_parser::TE_CHUNKED }
+  , { GZIP, http_parser::TE_GZIP }
+  , { DEFLATE, http_parser::TE_DEFLATE }
+  , { BR, http_parser::TE_BR }
+  , { IDENTITY, http_parser::TE_IDENTITY }
+  };
+
+enum http_host_state
+  {
+    s_http_host_dead = 1
+  , s_http_userinfo_start
+  , s_http_userinfo
+  , s_http_host_start
+  , s_http_host_v6_start
+  , s_http_host
+  , s_http_host_v6
+  , s_http_host_v6_end
+  , s_http_host_port_start
+  , s_http_host_port
+};
+
+
+/* Macros for character classes */
+#define CR                  '\r'
+#define LF                  '\n'
+#define QT                  '"'
+#define BS                  '\\'
+#define LOWER(c)            (unsigned char)(c | 0x20)
+#define TOKEN(c)            (tokens[(unsigned char)c])
+#define IS_ALPHA(c)         (LOWER(c) >= 'a' && LOWER(c) <= 'z')
+#define IS_NUM(c)           ((c) >= '0' && (c) <= '9')
+#define IS_ALPHANUM(c)      (IS_ALPHA(c) || IS_NUM(c))
+#define IS_HEX(c)           (IS_NUM(c) || (LOWER(c) >= 'a' && LOWER(c) <= 'f'))
+#define IS_MARK(c)          ((c) == '-' || (c) == '_' || (c) == '.' || \
+  (c) == '!' || (c) == '~' || (c) == '*' || (c) == '\'' || (c) == '(' || \
+  (c) == ')')
+#define IS_USERINFO_CHAR(c) (IS_ALPHANUM(c) || IS_MARK(c) || (c) == '%' || \
+  (c) == ';' || (c) == ':' || (c) == '&' || (c) == '=' || (c) == '+' || \
+  (c) == '$' || (c) == ',')
+
+/* URL and host character classes, generated for each parsing policy */
+enum char_classes
+  { C_URL               = 0x01
+  , C_HOST              = 0x02
+  };
+
+constexpr unsigned char
+char_class(unsigned char c, bool strict)
+{
+  unsigned char cls = 0;
+
+  if (normal_url_char[c] ||
+      (!strict && (c == '\t' || c == '\f' || (c & 0x80)))) {
+    cls |= C_URL;
+  }
+
+  if (IS_ALPHANUM(c) || c == '.' || c == '-' || (!strict && c == '_')) {
+    cls |= C_HOST;
+  }
+
+  return cls;
+}
+
+template <bool Strict>
+struct char_class_table {
+  unsigned char classes[256];
+
+  constexpr char_class_table() : classes() {
+    for (int c = 0; c < 256; c++) {
+      classes[c] = char_class((unsigned char) c, Strict);
+    }
+  }
+};
+
+template <bool Strict>
+inline constexpr char_class_table<Strict> char_class_tab {};
+
+/* These expect a Policy template parameter in scope */
+#define CHAR_CLASS(c)       (char_class_tab<Policy::strict>.classes[(unsigned char) (c)])
+#define IS_URL_CHAR(c)      (CHAR_CLASS(c) & C_URL)
+#define IS_HOST_CHAR(c)     (CHAR_CLASS(c) & C_HOST)
+
+
+#define start_state (type == HTTP_REQUEST ? s_pre_start_req : s_pre_start_res)
+
+/* The message type, known at compile time unless the policy allows both */
+#define PARSER_TYPE \
+  (Policy::type == HTTP_BOTH ? (enum http_parser_type) type : Policy::type)
+
+/* Case labels of execute()'s state switch. With computed gotos, every
+ * state also gets a label of its own (l_<state>), which the threaded
+ * policies jump to directly through state_labels.
+ */
+#if HTTP_PARSER_COMPUTED_GOTO
+# define STATE(s)           case s: l_##s: __attribute__((unused));
+#else
+# define STATE(s)           case s:
+#endif
+
+/* Ends the handling of the current byte; the break of the state switch.
+ * Threaded policies advance to the next byte and dispatch on the new state
+ * right here, so that every state gets its own copy of the dispatch.
+ */
+#if HTTP_PARSER_COMPUTED_GOTO
+# define NEXT_BYTE()                                                 \
+do {                                                                 \
+  if constexpr (Policy::threaded) {                                  \
+    if (++p == data + len) goto end_of_data;                         \
+    ch = *p;                                                         \
+    goto reexecute_byte;                                             \
+  }                                                                  \
+  goto next_byte;                                                    \
+} while (0)
+#else
+# define NEXT_BYTE() goto next_byte
+#endif
+
+/* Case labels of states that exist for one message type only, or only for
+ * HTTP_BOTH. A policy that rules them out turns them into the internal
+ * state error, and the optimizer drops their code.
+ */
+#define BOTH_STATE(s)                                                \
+  STATE(s) if (Policy::type != HTTP_BOTH) goto invalid_state;
+#define REQUEST_STATE(s)                                             \
+  STATE(s) if (Policy::type == HTTP_RESPONSE) goto invalid_state;
+#define RESPONSE_STATE(s)                                            \
+  STATE(s) if (Policy::type == HTTP_REQUEST) goto invalid_state;
+
+/* Labels of the states above, indexed by enum state. States that
+ * execute() never enters lead to the internal state error.
+ */
+#define STATE_LABELS                                                 \
+  &&invalid_state, &&invalid_state, &&l_s_pre_start_req_or_res,      \
+  &&l_s_start_req_or_res, &&l_s_res_or_resp_H, &&l_s_pre_start_res,  \
+  &&l_s_start_res, &&l_s_res_H, &&l_s_res_HT, &&l_s_res_HTT,         \
+  &&l_s_res_HTTP, &&l_s_res_first_http_major, &&l_s_res_http_major,  \
+  &&l_s_res_first_http_minor, &&l_s_res_http_minor,                  \
+  &&l_s_res_first_status_code, &&l_s_res_status_code, &&invalid_state, \
+  &&l_s_res_status, &&l_s_res_line_almost_done, &&l_s_pre_start_req, \
+  &&l_s_start_req, &&l_s_req_method, &&l_s_req_spaces_before_url,    \
+  &&l_s_req_schema, &&l_s_req_schema_slash, &&l_s_req_schema_slash_slash, \
+  &&invalid_state, &&invalid_state, &&invalid_state, &&l_s_req_host_start, \
+  &&l_s_req_host, &&l_s_req_host_ipv6, &&l_s_req_host_done,          \
+  &&l_s_req_port, &&l_s_req_path, &&l_s_req_query_string_start,      \
+  &&l_s_req_query_string, &&l_s_req_fragment_start, &&l_s_req_fragment, \
+  &&l_s_req_http_start, &&l_s_req_http_H, &&l_s_req_http_HT,         \
+  &&l_s_req_http_HTT, &&l_s_req_http_HTTP, &&l_s_req_first_http_major, \
+  &&l_s_req_http_major, &&l_s_req_first_http_minor, &&l_s_req_http_minor, \
+  &&l_s_req_line_almost_done, &&l_s_header_field_start,              \
+  &&l_s_header_field, &&l_s_header_value_start, &&l_s_header_value,  \
+  &&l_s_header_value_lws, &&l_s_header_almost_done,                  \
+  &&l_s_chunk_size_start, &&l_s_chunk_size, &&l_s_chunk_parameters,  \
+  &&l_s_chunk_extensions, &&l_s_chunk_size_almost_done,              \
+  &&l_s_headers_almost_done, &&l_s_trailers_done, &&l_s_headers_done, \
+  &&l_s_chunk_data, &&l_s_chunk_data_almost_done, &&l_s_chunk_data_done, \
+  &&l_s_body_identity, &&l_s_body_identity_eof, &&l_s_message_done
+
+#define STRICT_CHECK(cond)                                           \
+do {                                                                 \
+  if (Policy::strict && (cond)) {                                    \
+    SET_ERRNO(HPE_STRICT);                                           \
+    goto error;                                                      \
+  }                                                                  \
+} while (0)
+/* The chunk-size line, extensions included, is limited to
+ * HTTP_MAX_CHUNK_EXTENSION_SIZE bytes across all buffers.
+ */
+#define CHECK_CHUNK_LINE_SIZE()                                      \
+do {                                                                 \
+  if (nread + (p - data_or_header_data_start) >                      \
+      HTTP_MAX_CHUNK_EXTENSION_SIZE) {                               \
+    SET_ERRNO(HPE_CHUNK_EXTENSION_OVERFLOW);                         \
+    goto error;                                                      \
+  }                                                                  \
+} while (0)
+#define NEW_MESSAGE() \
+  (PARSER_TYPE == HTTP_REQUEST ? s_pre_start_req : s_pre_start_res)
+
+/* Called when a transfer coding ends (delimiter, parameters or end of
+ * line). Folds it into the TE_* mask; returns 0 if a coding follows
+ * chunked, which must always be the final coding (RFC 7230 3.3.1).
+ */
+inline int
+transfer_coding_done(unsigned char *mask, unsigned char hs, unsigned char index)
+{
+  unsigned char coding = http_parser::TE_OTHER;
+
+  if (hs >= h_matching_te_chunked && hs <= h_matching_te_identity) {
+    const char *name = te_codings[hs - h_matching_te_chunked].name;
+    if (name[index + 1] == '\0') {
+      coding = te_codings[hs - h_matching_te_chunked].coding;
+    }
+  }
+
+  if (*mask & http_parser::TE_CHUNKED) {
+    return 0;
+  }
+
+  *mask |= coding;
+  return 1;
+}
+
+/* Whether HS is between codings or in the parameters of one, where a
+ * folded line carries the coding list on.
+ */
+inline bool
+in_coding_list(unsigned char hs)
+{
+  return hs == h_transfer_encoding ||
+         (hs >= h_transfer_encoding_params && hs <= h_transfer_encoding_params_quote_escape);
+}
+
+/* Whether S is a state that export_state() can write: every field in
+ * range and consistent with the state, so that execute() never indexes
+ * method_strings[] or te_codings[] past their ends, never reads a body
+ * with a length that is not positive and never enters a chunk state of a
+ * message that is not chunked.
+ */
+inline bool
+valid_exported_state(const http_parser::exported_state& s)
+{
+  const unsigned known_flags = http_parser::F_CHUNKED | http_parser::F_BYPASSBODY |
+    http_parser::F_TRAILING | http_parser::F_UPGRADE | http_parser::F_SKIPBODY;
+  const unsigned known_codings = http_parser::TE_CHUNKED | http_parser::TE_GZIP |
+    http_parser::TE_DEFLATE | http_parser::TE_BR | http_parser::TE_IDENTITY |
+    http_parser::TE_OTHER;
+
+  if (s.version != http_parser::exported_state::current_version ||
+      s.reserved != 0 ||
+      (s.http_errno == HPE_OK && s.nread > HTTP_MAX_HEADER_SIZE) ||
+      s.content_length < -1 ||
+      s.status_code > 999 || s.http_major > 999 || s.http_minor > 999 ||
+      s.header_state > h_matching_te_identity ||
+      (s.flags & ~known_flags) != 0 ||
+      s.type > http_parser::HTTP_BOTH ||
+      s.method > http_parser::HTTP_PATCH ||
+      (s.transfer_encoding & ~known_codings) != 0 ||
+      s.http_errno > HPE_UNKNOWN ||
+      s.upgrade > 1) {
+    return false;
+  }
+
+  switch (s.header_state) {
+    case h_matching_content_length:
+      if (s.index >= sizeof(CONTENT_LENGTH) - 1) return false;
+      break;
+    case h_matching_transfer_encoding:
+      if (s.index >= sizeof(TRANSFER_ENCODING) - 1) return false;
+      break;
+    case h_matching_upgrade:
+      if (s.index >= sizeof(UPGRADE) - 1) return false;
+      break;
+    case h_matching_te_chunked:
+    case h_matching_te_gzip:
+    case h_matching_te_deflate:
+    case h_matching_te_br:
+    case h_matching_te_identity:
+      if (s.index >= strlen(te_codings[s.header_state - h_matching_te_chunked].name)) {
+        return false;
+      }
+      break;
+  }
+
+  switch (s.state) {
+    /* URL parser states that execute() never enters */
+    case s_res_status_start:
+    case s_req_server_start:
+    case s_req_server:
+    case s_req_server_with_at:
+      return false;
+
+    case s_req_method:
+      return s.index <= strlen(method_strings[s.method]);
+
+    /* a field is matched against the headers execute() looks into */
+    case s_header_field:
+      return s.header_state == h_general ||
+             (s.header_state >= h_matching_content_length && s.header_state <= h_upgrade);
+
+    /* Content-Length is accumulated from its first digit on */
+    case s_header_value:
+      return s.header_state != h_content_length || s.content_length >= 0;
+
+    case s_body_identity:
+      return s.content_length > 0;
+
+    case s_chunk_data:
+      return (s.flags & http_parser::F_CHUNKED) && s.content_length > 0;
+
+    case s_chunk_data_almost_done:
+      return (s.flags & http_parser::F_CHUNKED) && s.content_length == 0;
+
+    /* the size is accumulated from its first digit on */
+    case s_chunk_size:
+    case s_chunk_parameters:
+    case s_chunk_extensions:
+    case s_chunk_size_almost_done:
+      return (s.flags & http_parser::F_CHUNKED) && s.content_length >= 0;
+
+    case s_chunk_size_start:
+    case s_chunk_data_done:
+      return (s.flags & http_parser::F_CHUNKED) != 0;
+
+    default:
+      return s.state >= s_pre_start_req_or_res && s.state <= s_message_done;
+  }
+}
+
+/* Map errno values to strings for human-readable output */
+#define HTTP_STRERROR_GEN(n, s) { "HPE_" #n, s },
+struct http_strerror {
+  const char *name;
+  const char *description;
+};
+
+inline constexpr http_strerror http_strerror_tab[] = {
+  HTTP_ERRNO_MAP(HTTP_STRERROR_GEN)
+};
+#undef HTTP_STRERROR_GEN
+
+/* Our URL parser.
+ *
+ * This is designed to be shared by http_parser_execute() for URL validation,
+ * hence it has a state transition + byte-for-byte interface. In addition, it
+ * is meant to be embedded in http_parser_parse_url(), which does the dirty
+ * work of turning state transitions URL components for its API.
+ *
+ * This function should only be invoked with non-space characters. It is
+ * assumed that the caller cares about (and can detect) the transition between
+ * URL and non-URL states by looking for these.
+ */
+template <class Policy>
+inline enum state
+parse_url_char(enum state s, const char ch)
+{
+  if (ch == ' ' || ch == '\r' || ch == '\n') {
+    return s_dead;
+  }
+
+  if (Policy::strict && (ch == '\t' || ch == '\f')) {
+    return s_dead;
+  }
+
+  switch (s) {
+    case s_req_spaces_before_url:
+      /* Proxied requests are followed by scheme of an absolute URI (alpha).
+       * All methods except CONNECT are followed by '/' or '*'.
+       */
+
+      if (ch == '/' || ch == '*') {
+        return s_req_path;
+      }
+
+      if (IS_ALPHA(ch)) {
+        return s_req_schema;
+      }
+
+      break;
+
+    case s_req_schema:
+      if (IS_ALPHA(ch)) {
+        return s;
+      }
+
+      if (ch == ':') {
+        return s_req_schema_slash;
+      }
+
+      break;
+
+    case s_req_schema_slash:
+      if (ch == '/') {
+        return s_req_schema_slash_slash;
+      }
+
+      break;
+
+    case s_req_schema_slash_slash:
+      if (ch == '/') {
+        return s_req_server_start;
+      }
+
+      break;
+
+    case s_req_server_with_at:
+      if (ch == '@') {
+        return s_dead;
+      }
+
+    /* FALLTHROUGH */
+    case s_req_server_start:
+    case s_req_server:
+      if (ch == '/') {
+        return s_req_path;
+      }
+
+      if (ch == '?') {
+        return s_req_query_string_start;
+      }
+
+      if (ch == '@') {
+        return s_req_server_with_at;
+      }
+
+      if (IS_USERINFO_CHAR(ch) || ch == '[' || ch == ']') {
+        return s_req_server;
+      }
+
+      break;
+
+    case s_req_path:
+      if (IS_URL_CHAR(ch)) {
+        return s;
+      }
+
+      switch (ch) {
+        case '?':
+          return s_req_query_string_start;
+
+        case '#':
+          return s_req_fragment_start;
+      }
+
+      break;
+
+    case s_req_query_string_start:
+    case s_req_query_string:
+      if (IS_URL_CHAR(ch)) {
+        return s_req_query_string;
+      }
+
+      switch (ch) {
+        case '?':
+          /* allow extra '?' in query string */
+          return s_req_query_string;
+
+        case '#':
+          return s_req_fragment_start;
+      }
+
+      break;
+
+    case s_req_fragment_start:
+      if (IS_URL_CHAR(ch)) {
+        return s_req_fragment;
+      }
+
+      switch (ch) {
+        case '?':
+          return s_req_fragment;
+
+        case '#':
+          return s;
+      }
+
+      break;
+
+    case s_req_fragment:
+      if (IS_URL_CHAR(ch)) {
+        return s;
+      }
+
+      switch (ch) {
+        case '?':
+        case '#':
+          return s;
+      }
+
+      break;
+
+    default:
+      break;
+  }
+
+  /* We should never fall out of the switch above unless there's an error */
+  return s_dead;
+}
+
+template <class Policy>
+inline http_host_state http_parse_host_char(http_host_state s, const char ch)
+{
+  switch(s) {
+    case s_http_userinfo:
+    case s_http_userinfo_start:
+      if (ch == '@') {
+        return s_http_host_start;
+      }
+
+      if (IS_USERINFO_CHAR(ch)) {
+        return s_http_userinfo;
+      }
+      break;
+
+    case s_http_host_start:
+      if (ch == '[') {
+        return s_http_host_v6_start;
+      }
+
+      if (IS_HOST_CHAR(ch)) {
+        return s_http_host;
+      }
+
+      break;
+
+    case s_http_host:
+      if (IS_HOST_CHAR(ch)) {
+        return s_http_host;
+      }
+
+    /* FALLTHROUGH */
+    case s_http_host_v6_end:
+      if (ch == ':') {
+        return s_http_host_port_start;
+      }
+
+      break;
+
+    case s_http_host_v6:
+      if (ch == ']') {
+        return s_http_host_v6_end;
+      }
+
+    /* FALLTHROUGH */
+    case s_http_host_v6_start:
+      if (IS_HEX(ch) || ch == ':' || ch == '.') {
+        return s_http_host_v6;
+      }
+
+      break;
+
+    case s_http_host_port:
+    case s_http_host_port_start:
+      if (IS_NUM(ch)) {
+        return s_http_host_port;
+      }
+
+      break;
+
+    default:
+      break;
+  }
+  return s_http_host_dead;
+}
+
+template <class Policy>
+inline int http_parse_host(const char * buf, struct http_parser_url *u, int found_at)
+{
+  enum http_host_state s;
+
+  const char *p;
+  size_t buflen = u->field_data[UF_HOST].off + u->field_data[UF_HOST].len;
+
+  u->field_data[UF_HOST].len = 0;
+
+  s = found_at ? s_http_userinfo_start : s_http_host_start;
+
+  for (p = buf + u->field_data[UF_HOST].off; p < buf + buflen; p++) {
+    enum http_host_state new_s = http_parse_host_char<Policy>(s, *p);
+
+    if (new_s == s_http_host_dead) {
+      return 1;
+    }
+
+    switch(new_s) {
+      case s_http_host:
+        if (s != s_http_host) {
+          u->field_data[UF_HOST].off = p - buf;
+        }
+        u->field_data[UF_HOST].len++;
+        break;
+
+      case s_http_host_v6:
+        if (s != s_http_host_v6) {
+          u->field_data[UF_HOST].off = p - buf;
+        }
+        u->field_data[UF_HOST].len++;
+        break;
+
+      case s_http_host_port:
+        if (s != s_http_host_port) {
+          u->field_data[UF_PORT].off = p - buf;
+          u->field_data[UF_PORT].len = 0;
+          u->field_set |= (1 << UF_PORT);
+        }
+        u->field_data[UF_PORT].len++;
+        break;
+
+      case s_http_userinfo:
+        if (s != s_http_userinfo) {
+          u->field_data[UF_USERINFO].off = p - buf ;
+          u->field_data[UF_USERINFO].len = 0;
+          u->field_set |= (1 << UF_USERINFO);
+        }
+        u->field_data[UF_USERINFO].len++;
+        break;
+
+      default:
+        break;
+    }
+    s = new_s;
+  }
+
+  /* Make sure we don't end somewhere unexpected */
+  switch (s) {
+    case s_http_host_start:
+    case s_http_host_v6_start:
+    case s_http_host_v6:
+    case s_http_host_port_start:
+    case s_http_userinfo:
+    case s_http_userinfo_start:
+      return 1;
+    default:
+      break;
+  }
+
+  return 0;
+}
+
+} /* namespace http_parser_detail */
+
+
+template <class Policy>
+int
+http_parser_parse_url(const char *buf, size_t buflen, int is_connect,
+                      struct http_parser_url *u)
+{
+  using namespace http_parser_detail;
+
+  enum state s;
+  const char *p;
+  enum http_parser_url_fields uf, old_uf;
+  int found_at = 0;
+
+  u->port = u->field_set = 0;
+  s = is_connect ? s_req_server_start : s_req_spaces_before_url;
+  uf = old_uf = UF_MAX;
+
+  for (p = buf; p < buf + buflen; p++) {
+    s = parse_url_char<Policy>(s, *p);
+
+    /* Figure out the next field that we're operating on */
+    switch (s) {
+      case s_dead:
+        return 1;
+
+      /* Skip delimeters */
+      case s_req_schema_slash:
+      case s_req_schema_slash_slash:
+      case s_req_server_start:
+      case s_req_query_string_start:
+      case s_req_fragment_start:
+        continue;
+
+      case s_req_schema:
+        uf = UF_SCHEMA;
+        break;
+
+      case s_req_server_with_at:
+        found_at = 1;
+
+      /* FALLTHROUGH */
+      case s_req_server:
+        uf = UF_HOST;
+        break;
+
+      case s_req_path:
+        uf = UF_PATH;
+        break;
+
+      case s_req_query_string:
+        uf = UF_QUERY;
+        break;
+
+      case s_req_fragment:
+        uf = UF_FRAGMENT;
+        break;
+
+      default:
+        assert(!"Unexpected state");
+        return 1;
+    }
+
+    /* Nothing's changed; soldier on */
+    if (uf == old_uf) {
+      u->field_data[uf].len++;
+      continue;
+    }
+
+    u->field_data[uf].off = p - buf;
+    u->field_data[uf].len = 1;
+
+    u->field_set |= (1 << uf);
+    old_uf = uf;
+  }
+
+  /* host must be present if there is a schema */
+  /* parsing http:///toto will fail */
+  if ((u->field_set & ((1 << UF_SCHEMA) | (1 << UF_HOST))) != 0) {
+    if (http_parse_host<Policy>(buf, u, found_at) != 0) {
+      return 1;
+    }
+  }
+
+  /* CONNECT requests can only contain "hostname:port" */
+  if (is_connect && u->field_set != ((1 << UF_HOST)|(1 << UF_PORT))) {
+    return 1;
+  }
+
+  if (u->field_set & (1 << UF_PORT)) {
+    /* Don't bother with endp; we've already validated the string */
+    unsigned long v = strtoul(buf + u->field_data[UF_PORT].off, nullptr, 10);
+
+    /* Ports have a max value of 2^16 */
+    if (v > 0xffff) {
+      return 1;
+    }
+
+    u->port = (uint16_t) v;
+  }
+
+  return 0;
+}
+
+HTTP_PARSER_INLINE int
+http_parser_parse_url(const char *buf, size_t buflen, int is_connect,
+                      struct http_parser_url *u)
+{
+  return http_parser_parse_url<http_parser_default_policy>(buf, buflen, is_connect, u);
+}
+
+
+HTTP_PARSER_INLINE http_parser::http_parser(http_parser_type t)
+{
+    reset(t);
+}
+
+HTTP_PARSER_INLINE void http_parser::reset(http_parser_type t)
+{
+    using namespace http_parser_detail;
+
+    this->m_content_length = 0;
+    this->nread = 0;
+    this->state = (t == HTTP_REQUEST ? s_pre_start_req : (t == HTTP_RESPONSE ? s_pre_start_res : s_pre_start_req_or_res));
+    this->header_state = h_general;
+    this->index = 0;
+    this->flags = 0;
+    this->m_status_code = 0;
+    this->m_http_major = 0;
+    this->m_http_minor = 0;
+    this->type = t;
+    this->m_method = 0;
+    this->m_transfer_encoding = 0;
+    this->m_http_errno = HPE_OK;
+    this->m_upgrade = 0;
+}
+
+HTTP_PARSER_INLINE std::size_t http_parser::execute(const parser_settings& settings, const char *data, size_t len)
+{
+	return execute<http_parser_default_policy>(settings, data, len, nullptr);
+}
+
+HTTP_PARSER_INLINE std::size_t http_parser::execute_dechunk(const parser_settings& settings, char *data, size_t len)
+{
+	return execute<http_parser_default_policy>(settings, data, len, data);
+}
+
+template <class Policy, class Settings>
+std::size_t http_parser::execute(const Settings& settings, const char *data, size_t len)
+{
+	return execute<Policy>(settings, data, len, nullptr);
+}
+
+template <class Policy, class Settings>
+std::size_t http_parser::execute_dechunk(const Settings& settings, char *data, size_t len)
+{
+	return execute<Policy>(settings, data, len, data);
+}
+
+/* DECHUNK is either null or a writable alias of DATA. In the latter case
+ * chunk payloads are moved down over the chunk framing as they are parsed
+ * and handed to on_body as a single span per call.
+ */
+template <class Policy, class Settings>
+std::size_t http_parser::execute(const Settings& settings, const char *data, size_t len, char *dechunk)
+{
+	using namespace http_parser_detail;
+
+	char c, ch;
+	int8_t unhex_val;
+	const char *p = data;
+
+	/* Optimization: within the parsing loop below, we refer to this
+	* local copy of the state rather than state.  The compiler
+	* can't be sure whether state will change during a callback,
+	* so it generates a lot of memory loads and stores to keep a register
+	* copy of the state in sync with the memory copy.  We know, however,
+	* that the callbacks aren't allowed to change the parser state, so
+	* the parsing loop works with this local variable and only copies
+	* the value back to loop before returning or invoking a
+	* callback.
+	*/
+	unsigned char state = this->state;
+
+	assert(Policy::type == HTTP_BOTH || type == Policy::type);
+
+	/* We're in an error state. Don't bother doing anything. */
+	if (m_http_errno != HPE_OK)
+	{
+		RETURN(0);
+	}
+
+	if (len == 0)
+	{
+		if (STATE_ATTRIBUTES(state) & A_NEEDS_DATA) {
+			SET_ERRNO(HPE_INVALID_EOF_STATE);
+			RETURN(1);
+		}
+
+		if (state == s_body_identity_eof) {
+			/* Use of CALLBACK_NOTIFY() here would erroneously return 1 byte read if
+			* we got paused.
+			*/
+			CALLBACK_NOTIFY_NOADVANCE(message_complete);
+		}
+
+		RETURN(0);
+	}
+
+	/* technically we could combine all of these (except for url_mark) into one
+	variable, saving stack space, but it seems more clear to have them
+	separated. */
+	const char *header_field_mark = 0;
+	const char *header_value_mark = 0;
+	const char *url_mark = 0;
+	const char *reason_mark = 0;
+	const char *body_mark = 0;
+	const char *chunk_extension_mark = 0;
+
+	/* dechunk mode: start and length of the compacted body in this call */
+	char *dechunked = nullptr;
+	size_t dechunked_len = 0;
+
+	/* Resume the data callback that was running when we last returned */
+	switch (STATE_ATTRIBUTES(state) & A_MARK) {
+	case MARK_URL:
+		url_mark = data;
+		break;
+	case MARK_HEADER_FIELD:
+		header_field_mark = data;
+		break;
+	case MARK_HEADER_VALUE:
+		header_value_mark = data;
+		break;
+	case MARK_REASON:
+		reason_mark = data;
+		break;
+	case MARK_CHUNK_EXTENSION:
+		if (callback_set(settings.on_chunk_extension) && !dechunk)
+			chunk_extension_mark = data;
+		break;
+	default:
+		break;
+	}
+
+	/* Used only for overflow checking. If the parser is in a parsing-headers
+	* state, then its value is equal to max(data, the beginning of the current
+	* message or chunk). If the parser is in a not-parsing-headers state, then
+	* its value is irrelevant.
+	*/
+	const char* data_or_header_data_start = data;
+
+	for (p = data; p != data + len; p++) {
+		ch = *p;
+
+reexecute_byte:
+#if HTTP_PARSER_COMPUTED_GOTO
+		if constexpr (Policy::threaded) {
+			/* Direct threading: the optimizer copies this jump into the end
+			* of every state, so that each transition is predicted on its own
+			* instead of through the single indirect branch of the switch.
+			*/
+			static const void *const state_labels[] = { STATE_LABELS };
+			static_assert(sizeof(state_labels) / sizeof(state_labels[0]) == s_message_done + 1,
+			              "STATE_LABELS is out of sync with enum state");
+			goto *state_labels[state];
+		}
+#endif
+		switch (state) {
+
+		BOTH_STATE(s_pre_start_req_or_res)
+			if (ch == CR || ch == LF)
+				NEXT_BYTE();
+			state = s_start_req_or_res;
+			CALLBACK_NOTIFY_NOADVANCE(message_begin);
+			goto reexecute_byte;
+
+		BOTH_STATE(s_start_req_or_res)
+		{
+			flags = 0;
+			m_transfer_encoding = 0;
+			m_content_length = -1;
+
+			if (ch == 'H') {
+				state = s_res_or_resp_H;
+			} else {
+				type = HTTP_REQUEST;
+				state = s_start_req;
+				goto reexecute_byte;
+			}
+
+			NEXT_BYTE();
+		}
+
+		BOTH_STATE(s_res_or_resp_H)
+			if (ch == 'T') {
+				type = HTTP_RESPONSE;
+				state = s_res_HT;
+			} else {
+				if (ch != 'E') {
+					SET_ERRNO(HPE_INVALID_CONSTANT);
+					goto error;
+				}
+
+				type = HTTP_REQUEST;
+				m_method = HTTP_HEAD;
+				index = 2;
+				state = s_req_method;
+			}
+			NEXT_BYTE();
+
+		RESPONSE_STATE(s_pre_start_res)
+			if (ch == CR || ch == LF)
+				NEXT_BYTE();
+			state = s_start_res;
+			CALLBACK_NOTIFY_NOADVANCE(message_begin);
+			goto reexecute_byte;
+
+		RESPONSE_STATE(s_start_res)
+		{
+			flags = 0;
+			m_transfer_encoding = 0;
+			m_content_length = -1;
+
+			switch (ch) {
+			case 'H':
+				state = s_res_H;
+				break;
+
+			default:
+				SET_ERRNO(HPE_INVALID_CONSTANT);
+				goto error;
+			}
+
+			NEXT_BYTE();
+		}
+
+		RESPONSE_STATE(s_res_H)
+			STRICT_CHECK(ch != 'T');
+			state = s_res_HT;
+			NEXT_BYTE();
+
+		RESPONSE_STATE(s_res_HT)
+			STRICT_CHECK(ch != 'T');
+			state = s_res_HTT;
+			NEXT_BYTE();
+
+		RESPONSE_STATE(s_res_HTT)
+			STRICT_CHECK(ch != 'P');
+			state = s_res_HTTP;
+			NEXT_BYTE();
+
+		RESPONSE_STATE(s_res_HTTP)
+			STRICT_CHECK(ch != '/');
+			state = s_res_first_http_major;
+			NEXT_BYTE();
+
+		RESPONSE_STATE(s_res_first_http_major)
+			if (ch < '0' || ch > '9') {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			m_http_major = ch - '0';
+			state = s_res_http_major;
+			NEXT_BYTE();
+
+			/* major HTTP version or dot */
+		RESPONSE_STATE(s_res_http_major)
+		{
+			if (ch == '.') {
+				state = s_res_first_http_minor;
+				NEXT_BYTE();
+			}
+
+			if (!IS_NUM(ch)) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			/* the version and status fields are 10 bits wide, so reject
+			* anything above 999 before it can wrap */
+			if (m_http_major > 99) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			m_http_major = m_http_major * 10 + (ch - '0');
+
+			NEXT_BYTE();
+		}
+
+		/* first digit of minor HTTP version */
+		RESPONSE_STATE(s_res_first_http_minor)
+			if (!IS_NUM(ch)) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			m_http_minor = ch - '0';
+			state = s_res_http_minor;
+			NEXT_BYTE();
+
+			/* minor HTTP version or end of request line */
+		RESPONSE_STATE(s_res_http_minor)
+		{
+			if (ch == ' ') {
+				state = s_res_first_status_code;
+				NEXT_BYTE();
+			}
+
+			if (!IS_NUM(ch)) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			if (m_http_minor > 99) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			m_http_minor = m_http_minor * 10 + (ch - '0');
+
+			NEXT_BYTE();
+		}
+
+		RESPONSE_STATE(s_res_first_status_code)
+		{
+			if (!IS_NUM(ch)) {
+				if (ch == ' ') {
+					NEXT_BYTE();
+				}
+
+				SET_ERRNO(HPE_INVALID_STATUS);
+				goto error;
+			}
+			m_status_code = ch - '0';
+			state = s_res_status_code;
+			NEXT_BYTE();
+		}
+
+		RESPONSE_STATE(s_res_status_code)
+		{
+			if (!IS_NUM(ch)) {
+				switch (ch) {
+				case ' ':
+					state = s_res_status;
+					break;
+				case CR:
+					state = s_res_line_almost_done;
+					break;
+				case LF:
+					state = s_header_field_start;
+					break;
+				default:
+					SET_ERRNO(HPE_INVALID_STATUS);
+					goto error;
+				}
+				NEXT_BYTE();
+			}
+
+			if (m_status_code > 99) {
+				SET_ERRNO(HPE_INVALID_STATUS);
+				goto error;
+			}
+
+			m_status_code = m_status_code * 10 + (ch - '0');
+
+			NEXT_BYTE();
+		}
+
+		RESPONSE_STATE(s_res_status)
+			/* the human readable status. e.g. "NOT FOUND" */
+			MARK(reason);
+			if (ch == CR) {
+				state = s_res_line_almost_done;
+				CALLBACK_DATA(reason);
+				NEXT_BYTE();
+			}
+
+			if (ch == LF) {
+				state = s_header_field_start;
+				CALLBACK_DATA(reason);
+				NEXT_BYTE();
+			}
+			NEXT_BYTE();
+
+		RESPONSE_STATE(s_res_line_almost_done)
+			STRICT_CHECK(ch != LF);
+			state = s_header_field_start;
+			NEXT_BYTE();
+
+		REQUEST_STATE(s_pre_start_req)
+			if (ch == CR || ch == LF) {
+				NEXT_BYTE();
+			}
+			state = s_start_req;
+			CALLBACK_NOTIFY_NOADVANCE(message_begin);
+			goto reexecute_byte;
+
+		REQUEST_STATE(s_start_req)
+		{
+			flags = 0;
+			m_transfer_encoding = 0;
+			m_content_length = -1;
+
+			if (!IS_ALPHA(ch)) {
+				SET_ERRNO(HPE_INVALID_METHOD);
+				goto error;
+			}
+
+			m_method = (enum http_method) 0;
+			index = 1;
+			switch (ch) {
+			case 'C':
+				m_method = HTTP_CONNECT; /* or COPY, CHECKOUT */ break;
+			case 'D':
+				m_method = HTTP_DELETE;
+				break;
+			case 'G':
+				m_method = HTTP_GET;
+				break;
+			case 'H':
+				m_method = HTTP_HEAD;
+				break;
+			case 'L':
+				m_method = HTTP_LOCK;
+				break;
+			case 'M':
+				m_method = HTTP_MKCOL; /* or MOVE, MKACTIVITY, MERGE, M-SEARCH */ break;
+			case 'N':
+				m_method = HTTP_NOTIFY;
+				break;
+			case 'O':
+				m_method = HTTP_OPTIONS;
+				break;
+			case 'P':
+				m_method = HTTP_POST;
+				/* or PROPFIND or PROPPATCH or PUT or PATCH */
+				break;
+			case 'R':
+				m_method = HTTP_REPORT;
+				break;
+			case 'S':
+				m_method = HTTP_SUBSCRIBE;
+				break;
+			case 'T':
+				m_method = HTTP_TRACE;
+				break;
+			case 'U':
+				m_method = HTTP_UNLOCK; /* or UNSUBSCRIBE */ break;
+			default:
+				SET_ERRNO(HPE_INVALID_METHOD);
+				goto error;
+			}
+			state = s_req_method;
+
+			NEXT_BYTE();
+		}
+
+		REQUEST_STATE(s_req_method)
+		{
+			if (ch == '\0') {
+				SET_ERRNO(HPE_INVALID_METHOD);
+				goto error;
+			}
+
+			const char *matcher = method_strings[m_method];
+			if (ch == ' ' && matcher[index] == '\0') {
+				state = s_req_spaces_before_url;
+			} else if (ch == matcher[index]) {
+				; /* nada */
+			} else if (m_method == HTTP_CONNECT) {
+				if (index == 1 && ch == 'H') {
+					m_method = HTTP_CHECKOUT;
+				} else if (index == 2  && ch == 'P') {
+					m_method = HTTP_COPY;
+				} else {
+					SET_ERRNO(HPE_INVALID_METHOD);
+					goto error;
+				}
+			} else if (m_method == HTTP_MKCOL) {
+				if (index == 1 && ch == 'O') {
+					m_method = HTTP_MOVE;
+				} else if (index == 1 && ch == 'E') {
+					m_method = HTTP_MERGE;
+				} else if (index == 1 && ch == '-') {
+					m_method = HTTP_MSEARCH;
+				} else if (index == 2 && ch == 'A') {
+					m_method = HTTP_MKACTIVITY;
+				} else {
+					SET_ERRNO(HPE_INVALID_METHOD);
+					goto error;
+				}
+			} else if (index == 1 && m_method == HTTP_POST) {
+				if (ch == 'R') {
+					m_method = HTTP_PROPFIND; /* or HTTP_PROPPATCH */
+				} else if (ch == 'U') {
+					m_method = HTTP_PUT;
+				} else if (ch == 'A') {
+					m_method = HTTP_PATCH;
+				} else {
+					SET_ERRNO(HPE_INVALID_METHOD);
+					goto error;
+				}
+			} else if (index == 2 && m_method == HTTP_UNLOCK && ch == 'S') {
+				m_method = HTTP_UNSUBSCRIBE;
+			} else if (index == 4 && m_method == HTTP_PROPFIND && ch == 'P') {
+				m_method = HTTP_PROPPATCH;
+			} else {
+				SET_ERRNO(HPE_INVALID_METHOD);
+				goto error;
+			}
+
+			++index;
+			NEXT_BYTE();
+		}
+
+		REQUEST_STATE(s_req_spaces_before_url)
+		{
+			if (ch == ' ') NEXT_BYTE();
+
+			// CONNECT requests must be followed by a <host>:<port>
+			if (m_method == HTTP_CONNECT) {
+				MARK(url);
+				state = s_req_host_start;
+				goto reexecute_byte;
+			}
+
+			if (ch == '/' || ch == '*') {
+				MARK(url);
+				state = s_req_path;
+				NEXT_BYTE();
+			}
+
+			/* Proxied requests are followed by scheme of an absolute URI (alpha).
+			* All other methods are followed by '/' or '*' (handled above).
+			*/
+			if (IS_ALPHA(ch)) {
+				MARK(url);
+				state = s_req_schema;
+				NEXT_BYTE();
+			}
+
+			SET_ERRNO(HPE_INVALID_URL);
+			goto error;
+		}
+
+		REQUEST_STATE(s_req_schema)
+		{
+			if (IS_ALPHA(ch)) NEXT_BYTE();
+
+			if (ch == ':') {
+				state = s_req_schema_slash;
+				NEXT_BYTE();
+			}
+
+			SET_ERRNO(HPE_INVALID_URL);
+			goto error;
+		}
+
+		REQUEST_STATE(s_req_schema_slash)
+			STRICT_CHECK(ch != '/');
+			state = s_req_schema_slash_slash;
+			NEXT_BYTE();
+
+		REQUEST_STATE(s_req_schema_slash_slash)
+			STRICT_CHECK(ch != '/');
+			state = s_req_host_start;
+			NEXT_BYTE();
+
+		REQUEST_STATE(s_req_host_start)
+			if (ch == '[') {
+				state = s_req_host_ipv6;
+				NEXT_BYTE();
+			} else if (IS_ALPHANUM(ch)) {
+				state = s_req_host;
+				NEXT_BYTE();
+			}
+
+			SET_ERRNO(HPE_INVALID_HOST);
+			goto error;
+
+		REQUEST_STATE(s_req_host)
+			if (IS_HOST_CHAR(ch)) NEXT_BYTE();
+			state = s_req_host_done;
+			goto reexecute_byte;
+
+		REQUEST_STATE(s_req_host_ipv6)
+			if (IS_HEX(ch) || ch == ':') NEXT_BYTE();
+			if (ch == ']') {
+				state = s_req_host_done;
+				NEXT_BYTE();
+			}
+
+			SET_ERRNO(HPE_INVALID_HOST);
+			goto error;
+
+		REQUEST_STATE(s_req_host_done)
+			switch (ch) {
+			case ':':
+				state = s_req_port;
+				break;
+			case '/':
+				state = s_req_path;
+				break;
+			case ' ':
+				/* The request line looks like:
+				*   "GET http://foo.bar.com HTTP/1.1"
+				* That is, there is no path.
+				*/
+				state = s_req_http_start;
+				CALLBACK_DATA(url);
+				break;
+			case '?':
+				state = s_req_query_string_start;
+				break;
+			default:
+				SET_ERRNO(HPE_INVALID_HOST);
+				goto error;
+			}
+
+			NEXT_BYTE();
+
+		REQUEST_STATE(s_req_port)
+		{
+			if (IS_NUM(ch)) NEXT_BYTE();
+			switch (ch) {
+			case '/':
+				state = s_req_path;
+				break;
+			case ' ':
+				/* The request line looks like:
+				*   "GET http://foo.bar.com:1234 HTTP/1.1"
+				* That is, there is no path.
+				*/
+				state = s_req_http_start;
+				CALLBACK_DATA(url);
+				break;
+			case '?':
+				state = s_req_query_string_start;
+				break;
+			default:
+				SET_ERRNO(HPE_INVALID_PORT);
+				goto error;
+			}
+			NEXT_BYTE();
+		}
+
+		REQUEST_STATE(s_req_path)
+		{
+			if (IS_URL_CHAR(ch)) NEXT_BYTE();
+
+			switch (ch) {
+			case ' ':
+				state = s_req_http_start;
+				CALLBACK_DATA(url);
+				break;
+			case CR:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_req_line_almost_done;
+				CALLBACK_DATA(url);
+				break;
+			case LF:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_header_field_start;
+				CALLBACK_DATA(url);
+				break;
+			case '?':
+				state = s_req_query_string_start;
+				break;
+			case '#':
+				state = s_req_fragment_start;
+				break;
+			default:
+				SET_ERRNO(HPE_INVALID_PATH);
+				goto error;
+			}
+			NEXT_BYTE();
+		}
+
+		REQUEST_STATE(s_req_query_string_start)
+		{
+			if (IS_URL_CHAR(ch)) {
+				state = s_req_query_string;
+				NEXT_BYTE();
+			}
+
+			switch (ch) {
+			case '?':
+				break; /* XXX ignore extra '?' ... is this right? */
+			case ' ':
+				state = s_req_http_start;
+				CALLBACK_DATA(url);
+				break;
+			case CR:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_req_line_almost_done;
+				CALLBACK_DATA(url);
+				break;
+			case LF:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_header_field_start;
+				CALLBACK_DATA(url);
+				break;
+			case '#':
+				state = s_req_fragment_start;
+				break;
+			default:
+				SET_ERRNO(HPE_INVALID_QUERY_STRING);
+				goto error;
+			}
+			NEXT_BYTE();
+		}
+
+		REQUEST_STATE(s_req_query_string)
+		{
+			if (IS_URL_CHAR(ch)) NEXT_BYTE();
+
+			switch (ch) {
+			case '?':
+				/* allow extra '?' in query string */
+				break;
+			case ' ':
+				state = s_req_http_start;
+				CALLBACK_DATA(url);
+				break;
+			case CR:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_req_line_almost_done;
+				CALLBACK_DATA(url);
+				break;
+			case LF:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_header_field_start;
+				CALLBACK_DATA(url);
+				break;
+			case '#':
+				state = s_req_fragment_start;
+				break;
+			default:
+				SET_ERRNO(HPE_INVALID_QUERY_STRING);
+				goto error;
+			}
+			NEXT_BYTE();
+		}
+
+		REQUEST_STATE(s_req_fragment_start)
+		{
+			if (IS_URL_CHAR(ch)) {
+				state = s_req_fragment;
+				NEXT_BYTE();
+			}
+
+			switch (ch) {
+			case ' ':
+				state = s_req_http_start;
+				CALLBACK_DATA(url);
+				break;
+			case CR:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_req_line_almost_done;
+				CALLBACK_DATA(url);
+				break;
+			case LF:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_header_field_start;
+				CALLBACK_DATA(url);
+				break;
+			case '?':
+				state = s_req_fragment;
+				break;
+			case '#':
+				break;
+			default:
+				SET_ERRNO(HPE_INVALID_FRAGMENT);
+				goto error;
+			}
+			NEXT_BYTE();
+		}
+
+		REQUEST_STATE(s_req_fragment)
+		{
+			if (IS_URL_CHAR(ch)) NEXT_BYTE();
+
+			switch (ch) {
+			case ' ':
+				state = s_req_http_start;
+				CALLBACK_DATA(url);
+				break;
+			case CR:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_req_line_almost_done;
+				CALLBACK_DATA(url);
+				break;
+			case LF:
+				m_http_major = 0;
+				m_http_minor = 9;
+				state = s_header_field_start;
+				CALLBACK_DATA(url);
+				break;
+			case '?':
+			case '#':
+				break;
+			default:
+				SET_ERRNO(HPE_INVALID_FRAGMENT);
+				goto error;
+			}
+			NEXT_BYTE();
+		}
+
+		REQUEST_STATE(s_req_http_start)
+			switch (ch) {
+			case 'H':
+				state = s_req_http_H;
+				break;
+			case ' ':
+				break;
+			default:
+				SET_ERRNO(HPE_INVALID_CONSTANT);
+				goto error;
+			}
+			NEXT_BYTE();
+
+		REQUEST_STATE(s_req_http_H)
+			STRICT_CHECK(ch != 'T');
+			state = s_req_http_HT;
+			NEXT_BYTE();
+
+		REQUEST_STATE(s_req_http_HT)
+			STRICT_CHECK(ch != 'T');
+			state = s_req_http_HTT;
+			NEXT_BYTE();
+
+		REQUEST_STATE(s_req_http_HTT)
+			STRICT_CHECK(ch != 'P');
+			state = s_req_http_HTTP;
+			NEXT_BYTE();
+
+		REQUEST_STATE(s_req_http_HTTP)
+			STRICT_CHECK(ch != '/');
+			state = s_req_first_http_major;
+			NEXT_BYTE();
+
+			/* first digit of major HTTP version */
+		REQUEST_STATE(s_req_first_http_major)
+			if (ch < '0' || ch > '9') {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			m_http_major = ch - '0';
+			state = s_req_http_major;
+			NEXT_BYTE();
+
+			/* major HTTP version or dot */
+		REQUEST_STATE(s_req_http_major)
+		{
+			if (ch == '.') {
+				state = s_req_first_http_minor;
+				NEXT_BYTE();
+			}
+
+			if (!IS_NUM(ch)) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			if (m_http_major > 99) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			m_http_major = m_http_major * 10 + (ch - '0');
+
+			NEXT_BYTE();
+		}
+
+		/* first digit of minor HTTP version */
+		REQUEST_STATE(s_req_first_http_minor)
+			if (!IS_NUM(ch)) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			m_http_minor = ch - '0';
+			state = s_req_http_minor;
+			NEXT_BYTE();
+
+			/* minor HTTP version or end of request line */
+		REQUEST_STATE(s_req_http_minor)
+		{
+			if (ch == CR) {
+				state = s_req_line_almost_done;
+				NEXT_BYTE();
+			}
+
+			if (ch == LF) {
+				state = s_header_field_start;
+				NEXT_BYTE();
+			}
+
+			/* XXX allow spaces after digit? */
+
+			if (!IS_NUM(ch)) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			if (m_http_minor > 99) {
+				SET_ERRNO(HPE_INVALID_VERSION);
+				goto error;
+			}
+
+			m_http_minor = m_http_minor * 10 + (ch - '0');
+
+			NEXT_BYTE();
+		}
+
+		/* end of request line */
+		REQUEST_STATE(s_req_line_almost_done)
+		{
+			if (ch != LF) {
+				SET_ERRNO(HPE_LF_EXPECTED);
+				goto error;
+			}
+
+			state = s_header_field_start;
+			NEXT_BYTE();
+		}
+
+		STATE(s_header_field_start)
+		{
+			if (ch == CR) {
+				state = s_headers_almost_done;
+				NEXT_BYTE();
+			}
+
+			if (ch == LF) {
+				/* they might be just sending \n instead of \r\n so this would be
+				* the second \n to denote the end of headers*/
+				state = s_headers_almost_done;
+				goto reexecute_byte;
+			}
+
+			c = TOKEN(ch);
+
+			if (!c) {
+				SET_ERRNO(HPE_INVALID_HEADER_TOKEN);
+				goto error;
+			}
+
+			MARK(header_field);
+
+			index = 0;
+			state = s_header_field;
+
+			/* framing headers have no meaning in trailers */
+			if (flags & F_TRAILING) {
+				header_state = h_general;
+				NEXT_BYTE();
+			}
+
+			switch (c) {
+			case 'c':
+				header_state = h_matching_content_length;
+				break;
+
+			case 't':
+				header_state = h_matching_transfer_encoding;
+				break;
+
+			case 'u':
+				header_state = h_matching_upgrade;
+				break;
+
+			default:
+				header_state = h_general;
+				break;
+			}
+			NEXT_BYTE();
+		}
+
+		STATE(s_header_field)
+		{
+			c = TOKEN(ch);
+
+			if (c) {
+				switch (header_state) {
+				case h_general:
+
+					// fast-forwarding, wheeeeeee!
+#define MOVE_THE_HEAD do { \
+			++p;                     \
+			if (!TOKEN(*p)) {        \
+			ch = *p;               \
+			goto notatoken;        \
+			}                        \
+		} while(0);
+
+					if (data + len - p >= 9) {
+						MOVE_THE_HEAD
+						MOVE_THE_HEAD
+						MOVE_THE_HEAD
+						MOVE_THE_HEAD
+						MOVE_THE_HEAD
+						MOVE_THE_HEAD
+						MOVE_THE_HEAD
+						MOVE_THE_HEAD
+					} else if (data + len - p >= 4) {
+						MOVE_THE_HEAD
+						MOVE_THE_HEAD
+						MOVE_THE_HEAD
+					}
+
+					break;
+
+					/* content-length */
+
+				case h_matching_content_length:
+					index++;
+					if (index > sizeof(CONTENT_LENGTH)-1
+							|| c != CONTENT_LENGTH[index]) {
+						header_state = h_general;
+					} else if (index == sizeof(CONTENT_LENGTH)-2) {
+						header_state = h_content_length;
+					}
+					break;
+
+					/* transfer-encoding */
+
+				case h_matching_transfer_encoding:
+					index++;
+					if (index > sizeof(TRANSFER_ENCODING)-1
+							|| c != TRANSFER_ENCODING[index]) {
+						header_state = h_general;
+					} else if (index == sizeof(TRANSFER_ENCODING)-2) {
+						header_state = h_transfer_encoding;
+					}
+					break;
+
+					/* upgrade */
+
+				case h_matching_upgrade:
+					index++;
+					if (index > sizeof(UPGRADE)-1
+							|| c != UPGRADE[index]) {
+						header_state = h_general;
+					} else if (index == sizeof(UPGRADE)-2) {
+						header_state = h_upgrade;
+					}
+					break;
+
+				case h_content_length:
+				case h_transfer_encoding:
+				case h_upgrade:
+					if (ch != ' ') header_state = h_general;
+					break;
+
+				default:
+					assert(0 && "Unknown header_state");
+					break;
+				}
+				NEXT_BYTE();
+			}
+
+notatoken:
+			if (ch == ':') {
+				state = s_header_value_start;
+				CALLBACK_HEADER(field);
+				NEXT_BYTE();
+			}
+
+			SET_ERRNO(HPE_INVALID_HEADER_TOKEN);
+			goto error;
+		}
+
+		STATE(s_header_value_start)
+		{
+			if (ch == ' ' || ch == '\t') NEXT_BYTE();
+
+			MARK(header_value);
+
+			state = s_header_value;
+			index = 0;
+
+			/* An empty value may still be followed by a folded line; a
+			 * coding list carries on there.
+			 */
+			if (ch == CR) {
+				if (!in_coding_list(header_state)) {
+					header_state = h_general;
+				}
+				state = s_header_almost_done;
+				CALLBACK_HEADER(value);
+				NEXT_BYTE();
+			}
+
+			if (ch == LF) {
+				if (!in_coding_list(header_state)) {
+					header_state = h_general;
+				}
+				state = s_header_almost_done;
+				CALLBACK_HEADER_NOADVANCE(value);
+				goto reexecute_byte;
+			}
+
+			c = LOWER(ch);
+
+			switch (header_state) {
+			case h_upgrade:
+				flags |= F_UPGRADE;
+				header_state = h_general;
+				break;
+
+			case h_transfer_encoding:
+			case h_transfer_encoding_params:
+			case h_transfer_encoding_params_quote:
+			case h_transfer_encoding_params_quote_escape:
+				/* the coding list is tokenized by s_header_value */
+				goto reexecute_byte;
+
+			case h_content_length:
+				if (!IS_NUM(ch)) {
+					SET_ERRNO(HPE_INVALID_CONTENT_LENGTH);
+					goto error;
+				}
+
+				m_content_length = ch - '0';
+				break;
+
+			default:
+				header_state = ch == QT ? h_general_and_quote : h_general;
+				break;
+			}
+			NEXT_BYTE();
+		}
+
+		STATE(s_header_value)
+		{
+cr_or_lf_or_qt:
+			if (ch == CR &&
+					header_state != h_general_and_quote_and_escape) {
+				state = s_header_almost_done;
+				CALLBACK_HEADER(value);
+				NEXT_BYTE();
+			}
+
+			if (ch == LF &&
+					header_state != h_general_and_quote_and_escape) {
+				state = s_header_almost_done;
+				CALLBACK_HEADER_NOADVANCE(value);
+				goto reexecute_byte;
+			}
+
+			switch (header_state) {
+			case h_general:
+				/* quoted strings are scanned byte by byte for escapes */
+				if (ch == QT) {
+					header_state = h_general_and_quote;
+					break;
+				}
+
+				// fast-forwarding, wheee!
+#define MOVE_FAST do {                    \
+		++p;                                    \
+		ch = *p;                                \
+		if (ch == CR || ch == LF || ch == QT) { \
+			goto cr_or_lf_or_qt;                  \
+		}                                       \
+		} while(0);
+
+				if (data + len - p >= 12) {
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+				} else if (data + len - p >= 5) {
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+					MOVE_FAST
+				}
+
+				break;
+
+			case h_general_and_quote:
+				if (ch == QT) {
+					header_state = h_general;
+				} else if (ch == BS) {
+					header_state = h_general_and_quote_and_escape;
+				}
+				break;
+
+			case h_general_and_quote_and_escape:
+				header_state = h_general_and_quote;
+				break;
+
+
+			/* Transfer-Encoding: 1#transfer-coding */
+			case h_transfer_encoding:
+				if (ch == ' ' || ch == '\t' || ch == ',') break;
+
+				if (ch == ';') {
+					header_state = h_transfer_encoding_params;
+					break;
+				}
+
+				c = TOKEN(ch);
+				if (!c) {
+					SET_ERRNO(HPE_INVALID_TRANSFER_ENCODING);
+					goto error;
+				}
+
+				index = 0;
+				switch (c) {
+				case 'c': header_state = h_matching_te_chunked; break;
+				case 'g': header_state = h_matching_te_gzip; break;
+				case 'd': header_state = h_matching_te_deflate; break;
+				case 'b': header_state = h_matching_te_br; break;
+				case 'i': header_state = h_matching_te_identity; break;
+				default: header_state = h_transfer_encoding_token; break;
+				}
+				break;
+
+			/* A parameter ends at a comma outside a quoted string */
+			case h_transfer_encoding_params:
+				if (ch == ',') {
+					header_state = h_transfer_encoding;
+				} else if (ch == QT) {
+					header_state = h_transfer_encoding_params_quote;
+				}
+				break;
+
+			case h_transfer_encoding_params_quote:
+				if (ch == QT) {
+					header_state = h_transfer_encoding_params;
+				} else if (ch == BS) {
+					header_state = h_transfer_encoding_params_quote_escape;
+				}
+				break;
+
+			case h_transfer_encoding_params_quote_escape:
+				header_state = h_transfer_encoding_params_quote;
+				break;
+
+			case h_transfer_encoding_token:
+			case h_matching_te_chunked:
+			case h_matching_te_gzip:
+			case h_matching_te_deflate:
+			case h_matching_te_br:
+			case h_matching_te_identity:
+				if (ch == ' ' || ch == '\t' || ch == ',' || ch == ';') {
+					if (!transfer_coding_done(&m_transfer_encoding, header_state, index)) {
+						SET_ERRNO(HPE_INVALID_TRANSFER_ENCODING);
+						goto error;
+					}
+					header_state = ch == ';' ? h_transfer_encoding_params : h_transfer_encoding;
+					break;
+				}
+
+				c = TOKEN(ch);
+				if (!c) {
+					SET_ERRNO(HPE_INVALID_TRANSFER_ENCODING);
+					goto error;
+				}
+
+				if (header_state != h_transfer_encoding_token) {
+					index++;
+					if (c != te_codings[header_state - h_matching_te_chunked].name[index]) {
+						header_state = h_transfer_encoding_token;
+					}
+				}
+				break;
+
+			case h_content_length:
+				if (ch == ' ') break;
+				if (!IS_NUM(ch)) {
+					SET_ERRNO(HPE_INVALID_CONTENT_LENGTH);
+					goto error;
+				}
+
+				if (m_content_length > ((INT64_MAX - 10) / 10)) {
+					/* overflow */
+					SET_ERRNO(HPE_HUGE_CONTENT_LENGTH);
+					goto error;
+				}
+
+				m_content_length *= 10;
+				m_content_length += ch - '0';
+				break;
+
+			default:
+				state = s_header_value;
+				header_state = h_general;
+				break;
+			}
+			NEXT_BYTE();
+		}
+
+		STATE(s_header_almost_done)
+		{
+			STRICT_CHECK(ch != LF);
+
+			if (ch == LF) {
+				state = s_header_value_lws;
+			} else {
+				state = s_header_value;
+			}
+
+			switch (header_state) {
+			case h_transfer_encoding_token:
+			case h_matching_te_chunked:
+			case h_matching_te_gzip:
+			case h_matching_te_deflate:
+			case h_matching_te_br:
+			case h_matching_te_identity:
+				if (!transfer_coding_done(&m_transfer_encoding, header_state, index)) {
+					SET_ERRNO(HPE_INVALID_TRANSFER_ENCODING);
+					goto error;
+				}
+				/* a folded line may continue the list */
+				header_state = h_transfer_encoding;
+				break;
+			default:
+				break;
+			}
+
+			if (m_transfer_encoding & TE_CHUNKED) {
+				flags |= F_CHUNKED;
+			}
+
+			/* A bare CR (lenient only) is passed on as a space and the
+			 * value goes on with this byte.
+			 */
+			if (ch != LF) {
+				CALLBACK_HEADER_SPACE(value);
+				MARK(header_value);
+				goto reexecute_byte;
+			}
+
+			NEXT_BYTE();
+		}
+
+		STATE(s_header_value_lws)
+		{
+			if (ch == ' ' || ch == '\t')
+			{
+				state = s_header_value_start;
+				CALLBACK_HEADER_SPACE(value);
+			}
+			else
+			{
+				state = s_header_field_start;
+				goto reexecute_byte;
+			}
+			NEXT_BYTE();
+		}
+
+		STATE(s_headers_almost_done)
+		{
+			STRICT_CHECK(ch != LF);
+
+			if (flags & F_TRAILING) {
+				/* End of a chunked request */
+				state = s_trailers_done;
+				if (callback_set(settings.on_trailers_complete)) {
+					CALLBACK_NOTIFY_NOADVANCE(trailers_complete);
+				}
+				goto reexecute_byte;
+			}
+
+			state = s_headers_done;
+
+			/* Set this here so that on_headers_complete() callbacks can see it */
+			m_upgrade =
+				(flags & F_UPGRADE || m_method == HTTP_CONNECT);
+
+			/* Here we call the headers_complete callback. This is somewhat
+			* different than other callbacks because if the user returns 1, we
+			* will interpret that as saying that this message has no body. This
+			* is needed for the annoying case of receiving a response to a HEAD
+			* request.
+			*
+			* We'd like to use CALLBACK_NOTIFY_NOADVANCE() here but we cannot, so
+			* we have to simulate it by handling a change in errno below.
+			*/
+			size_t header_size = p - data + 1;
+			switch (settings.on_headers_complete(*this, nullptr, header_size)) {
+			case 0:
+				break;
+
+			case 1:
+				flags |= F_SKIPBODY;
+				break;
+
+			case 2:
+				flags |= F_BYPASSBODY;
+				break;
+
+			default:
+				SET_ERRNO(HPE_CB_headers_complete);
+				RETURN(p - data); /* Error */
+			}
+
+			if (m_http_errno != HPE_OK) {
+				RETURN(p - data);
+			}
+
+			goto reexecute_byte;
+		}
+
+		STATE(s_trailers_done)
+			state = s_message_done;
+			if (!dechunk) {
+				CALLBACK_NOTIFY_NOADVANCE(chunk_complete);
+			}
+			goto reexecute_byte;
+
+		STATE(s_headers_done)
+		{
+			STRICT_CHECK(ch != LF);
+
+			// we're done parsing headers, reset overflow counters
+			nread = 0;
+			// (if we now move to s_body_*, then this is irrelevant)
+			data_or_header_data_start = p;
+
+			int hasBody = flags & F_CHUNKED || m_content_length > 0;
+			if (m_upgrade && (m_method == HTTP_CONNECT ||
+									(flags & F_SKIPBODY) || !hasBody)) {
+				/* Exit, the rest of the message is in a different protocol. */
+				state = NEW_MESSAGE();
+				CALLBACK_NOTIFY(message_complete);
+				RETURN((p - data) + 1);
+			}
+
+			if (flags & F_SKIPBODY) {
+				state = NEW_MESSAGE();
+				CALLBACK_NOTIFY(message_complete);
+			} else if (flags & F_CHUNKED) {
+				/* chunked encoding - ignore Content-Length header */
+				state = s_chunk_size_start;
+			} else if (m_transfer_encoding & ~TE_IDENTITY) {
+				/* chunked is not the final coding, so nothing frames the body
+				* (RFC 7230 3.3.3): reject requests, read responses until EOF.
+				*/
+				if (PARSER_TYPE == HTTP_REQUEST) {
+					SET_ERRNO(HPE_INVALID_TRANSFER_ENCODING);
+					goto error;
+				}
+				state = s_body_identity_eof;
+			} else {
+				if (m_content_length == 0) {
+					/* Content-Length header given but zero: Content-Length: 0\r\n */
+					state = NEW_MESSAGE();
+					CALLBACK_NOTIFY(message_complete);
+				} else if (m_content_length > 0) {
+					/* Content-Length header given and non-zero */
+					state = s_body_identity;
+					if (flags & F_BYPASSBODY) {
+						/* The caller takes the body; see consume_body() */
+						RETURN((p - data) + 1);
+					}
+				} else {
+					unsigned short sc = m_status_code;
+					if (PARSER_TYPE == HTTP_REQUEST ||
+							((100 <= sc && sc <= 199) || sc == 204 || sc == 304)) {
+						/* Assume content-length 0 - read the next */
+						state = NEW_MESSAGE();
+						CALLBACK_NOTIFY(message_complete);
+					} else {
+						/* Read body until EOF */
+						state = s_body_identity_eof;
+					}
+				}
+			}
+
+			NEXT_BYTE();
+		}
+
+		STATE(s_body_identity)
+		{
+			uint64_t to_read = std::min(m_content_length, (data + len) - p);
+
+			assert(m_content_length > 0);
+
+			/* The difference between advancing content_length and p is because
+			* the latter will automatically advance on the next loop iteration.
+			* Further, if content_length ends up at 0, we want to see the last
+			* byte again for our message complete callback.
+			*/
+			MARK(body);
+			m_content_length -= to_read;
+			p += to_read - 1;
+
+			if (m_content_length == 0) {
+				state = s_message_done;
+
+				/* Mimic CALLBACK_DATA_NOADVANCE() but with one extra byte.
+				*
+				* The alternative to doing this is to wait for the next byte to
+				* trigger the data callback, just as in every other case. The
+				* problem with this is that this makes it difficult for the test
+				* harness to distinguish between complete-on-EOF and
+				* complete-on-length. It's not clear that this distinction is
+				* important for applications, but let's keep it for now.
+				*/
+				_CALLBACK_DATA(body, p - body_mark + 1, p - data);
+				goto reexecute_byte;
+			}
+
+			NEXT_BYTE();
+		}
+
+		/* read until EOF */
+		STATE(s_body_identity_eof)
+			MARK(body);
+			p = data + len - 1;
+
+			NEXT_BYTE();
+
+		STATE(s_message_done)
+			state = NEW_MESSAGE();
+			nread = 0;
+			data_or_header_data_start = p;
+			CALLBACK_NOTIFY(message_complete);
+			if (m_upgrade) {
+				/* Exit, the rest of the message is in a different protocol. */
+				RETURN((p - data) + 1);
+			}
+			NEXT_BYTE();
+
+		STATE(s_chunk_size_start)
+		{
+			assert(flags & F_CHUNKED);
+
+			unhex_val = unhex[(unsigned char)ch];
+			if (unhex_val == -1) {
+				SET_ERRNO(HPE_INVALID_CHUNK_SIZE);
+				goto error;
+			}
+
+			m_content_length = unhex_val;
+			state = s_chunk_size;
+			NEXT_BYTE();
+		}
+
+		STATE(s_chunk_size)
+		{
+			assert(flags & F_CHUNKED);
+
+			if (ch == CR) {
+				state = s_chunk_size_almost_done;
+				NEXT_BYTE();
+			}
+
+			unhex_val = unhex[(unsigned char)ch];
+
+			if (unhex_val == -1) {
+				if (ch == ';') {
+					state = s_chunk_extensions;
+					goto reexecute_byte;
+				}
+
+				if (ch == ' ') {
+					state = s_chunk_parameters;
+					NEXT_BYTE();
+				}
+
+				SET_ERRNO(HPE_INVALID_CHUNK_SIZE);
+				goto error;
+			}
+
+			if (m_content_length > (INT64_MAX - unhex_val) >> 4) {
+				/* overflow */
+				SET_ERRNO(HPE_HUGE_CHUNK_SIZE);
+				goto error;
+			}
+			m_content_length *= 16;
+			m_content_length += unhex_val;
+			/* leading zeros do not overflow */
+			CHECK_CHUNK_LINE_SIZE();
+			NEXT_BYTE();
+		}
+
+		STATE(s_chunk_parameters)
+		{
+			assert(flags & F_CHUNKED);
+			/* whitespace after the chunk size; anything else up to the first
+			* ';' is ignored as before
+			*/
+			if (ch == CR) {
+				state = s_chunk_size_almost_done;
+				NEXT_BYTE();
+			}
+
+			if (ch == ';') {
+				state = s_chunk_extensions;
+				goto reexecute_byte;
+			}
+			CHECK_CHUNK_LINE_SIZE();
+			NEXT_BYTE();
+		}
+
+		STATE(s_chunk_extensions)
+		{
+			assert(flags & F_CHUNKED);
+
+			if (callback_set(settings.on_chunk_extension) && !dechunk) {
+				MARK(chunk_extension);
+			}
+
+			if (ch != CR) {
+				/* skip ahead to the end of the line */
+				const char *cr = (const char *) memchr(p, CR, data + len - p);
+				if (cr == nullptr) {
+					p = data + len - 1;
+					NEXT_BYTE();
+				}
+				p = cr;
+				ch = CR;
+			}
+
+			CHECK_CHUNK_LINE_SIZE();
+
+			state = s_chunk_size_almost_done;
+			CALLBACK_DATA(chunk_extension);
+			NEXT_BYTE();
+		}
+
+		STATE(s_chunk_size_almost_done)
+		{
+			assert(flags & F_CHUNKED);
+			STRICT_CHECK(ch != LF);
+
+			if (m_content_length == 0) {
+				/* the body ends here; trailers and message_complete follow */
+				CALLBACK_DECHUNKED(p - data);
+				flags |= F_TRAILING;
+				state = s_header_field_start;
+				CALLBACK_CHUNK_NOTIFY(chunk_header);
+			} else {
+				state = s_chunk_data;
+				CALLBACK_CHUNK_NOTIFY(chunk_header);
+			}
+			NEXT_BYTE();
+		}
+
+		STATE(s_chunk_data)
+		{
+			uint64_t to_read = std::min(m_content_length, (data + len) - p);
+
+			assert(flags & F_CHUNKED);
+			assert(m_content_length > 0);
+
+			/* See the explanation in s_body_identity for why the content
+			* length and data pointers are managed this way.
+			*/
+			if (dechunk) {
+				char *src = dechunk + (p - data);
+				if (!dechunked) {
+					dechunked = src;
+				} else if (dechunked + dechunked_len != src) {
+					memmove(dechunked + dechunked_len, src, to_read);
+				}
+				dechunked_len += to_read;
+			} else {
+				MARK(body);
+			}
+			m_content_length -= to_read;
+			p += to_read - 1;
+
+			if (m_content_length == 0) {
+				state = s_chunk_data_almost_done;
+			}
+
+			NEXT_BYTE();
+		}
+
+		STATE(s_chunk_data_almost_done)
+			assert(flags & F_CHUNKED);
+			assert(m_content_length == 0);
+			STRICT_CHECK(ch != CR);
+			state = s_chunk_data_done;
+			CALLBACK_DATA(body);
+			NEXT_BYTE();
+
+		STATE(s_chunk_data_done)
+			assert(flags & F_CHUNKED);
+			STRICT_CHECK(ch != LF);
+			state = s_chunk_size_start;
+			nread = 0;
+			data_or_header_data_start = p;
+			CALLBACK_CHUNK_NOTIFY(chunk_complete);
+			NEXT_BYTE();
+
+		default:
+			assert(0 && "unhandled state");
+invalid_state:
+			SET_ERRNO(HPE_INVALID_INTERNAL_STATE);
+			goto error;
+		}
+next_byte:
+		;
+	}
+#if HTTP_PARSER_COMPUTED_GOTO
+end_of_data: __attribute__((unused));
+#endif
+
+	/* We can check for overflow here because in Proxygen, len <= ~8KB and so the
+	* worst thing that can happen is that we catch the overflow at 88KB rather
+	* than at 80KB.
+	* In case of chunk encoding, we count the overflow for every
+	* chunk separately.
+	* We zero the nread counter (and reset data_or_header_data_start) when we
+	* start parsing a new message or a new chunk.
+	*/
+	if (PARSING_HEADER(state)) {
+		nread += p - data_or_header_data_start;
+		if (nread > HTTP_MAX_HEADER_SIZE) {
+			SET_ERRNO(HPE_HEADER_OVERFLOW);
+			goto error;
+		}
+		if (PARSING_CHUNK_LINE(state) && nread > HTTP_MAX_CHUNK_EXTENSION_SIZE) {
+			SET_ERRNO(HPE_CHUNK_EXTENSION_OVERFLOW);
+			goto error;
+		}
+	}
+
+	/* Run callbacks for any marks that we have leftover after we ran out of
+	* bytes. There should be at most one of these set, so it's OK to invoke
+	* them in series (unset marks will not result in callbacks).
+	*
+	* We use the NOADVANCE() variety of callbacks here because 'p' has already
+	* overflowed 'data' and this allows us to correct for the off-by-one that
+	* we'd otherwise have (since CALLBACK_DATA() is meant to be run with a 'p'
+	* value that's in-bounds).
+	*/
+
+	assert(((header_field_mark ? 1 : 0) +
+			(header_value_mark ? 1 : 0) +
+			(url_mark ? 1 : 0)  +
+			(reason_mark ? 1 : 0)  +
+			(body_mark ? 1 : 0) +
+			(chunk_extension_mark ? 1 : 0)) <= 1);
+
+	CALLBACK_HEADER_NOADVANCE(field);
+	CALLBACK_HEADER_NOADVANCE(value);
+	CALLBACK_DATA_NOADVANCE(url);
+	CALLBACK_DATA_NOADVANCE(reason);
+	CALLBACK_DATA_NOADVANCE(body);
+	CALLBACK_DATA_NOADVANCE(chunk_extension);
+	CALLBACK_DECHUNKED(len);
+
+	RETURN(len);
+
+error:
+	if (m_http_errno == HPE_OK) {
+		SET_ERRNO(HPE_UNKNOWN);
+	}
+
+	/* Chunk payloads compacted before the error are covered by the
+	* returned offset, so they are delivered all the same.
+	*/
+	if (dechunked_len) {
+		this->state = state;
+		settings.on_body(*this, dechunked, dechunked_len);
+	}
+
+	RETURN(p - data);
+}
+
+HTTP_PARSER_INLINE void http_parser::pause(int paused)
+{
+    /* Users should only be pausing/unpausing a parser that is not in an error
+     * state. In non-debug builds, there's not much that we can do about this
+     * other than ignore it.
+     */
+
+    if (m_http_errno == HPE_OK || m_http_errno == HPE_PAUSED) {
+        SET_ERRNO((paused) ? HPE_PAUSED : HPE_OK);
+    } else {
+        assert(0 && "Attempting to pause parser in error state");
+    }
+}
+
+HTTP_PARSER_INLINE uint64_t http_parser::bypass_length()
+{
+    using namespace http_parser_detail;
+
+    if (state != s_body_identity || !(flags & F_BYPASSBODY)) {
+        return 0;
+    }
+
+    return m_content_length;
+}
+
+HTTP_PARSER_INLINE bool http_parser::body_is_final()
+{
+    using namespace http_parser_detail;
+
+    return state == s_message_done;
+}
+
+HTTP_PARSER_INLINE int http_parser::consume_body(const parser_settings& settings, uint64_t n)
+{
+    return consume_body<parser_settings>(settings, n);
+}
+
+template <class Settings>
+int http_parser::consume_body(const Settings& settings, uint64_t n)
+{
+    using namespace http_parser_detail;
+
+    if (m_http_errno != HPE_OK) {
+        return m_http_errno;
+    }
+
+    /* Not bypassing, or more than is left: the parser stays as it is */
+    if (state != s_body_identity || !(flags & F_BYPASSBODY) ||
+        n > (uint64_t) m_content_length) {
+        return HPE_INVALID_INTERNAL_STATE;
+    }
+
+    m_content_length -= n;
+
+    if (m_content_length == 0) {
+        state = start_state;
+        nread = 0;
+        if (0 != settings.on_message_complete(*this)) {
+            SET_ERRNO(HPE_CB_message_complete);
+        }
+    }
+
+    return m_http_errno;
+}
+
+HTTP_PARSER_INLINE void http_parser::export_state(exported_state& s) const
+{
+    s.version = exported_state::current_version;
+    s.nread = nread;
+    s.content_length = m_content_length;
+    s.status_code = m_status_code;
+    s.http_major = m_http_major;
+    s.http_minor = m_http_minor;
+    s.state = state;
+    s.header_state = header_state;
+    s.index = index;
+    s.flags = flags;
+    s.type = type;
+    s.method = m_method;
+    s.transfer_encoding = m_transfer_encoding;
+    s.http_errno = m_http_errno;
+    s.upgrade = m_upgrade;
+    s.reserved = 0;
+}
+
+HTTP_PARSER_INLINE int http_parser::import_state(const exported_state& s)
+{
+    using namespace http_parser_detail;
+
+    if (!valid_exported_state(s)) {
+        return HPE_INVALID_INTERNAL_STATE;
+    }
+
+    this->m_content_length = s.content_length;
+    this->nread = s.nread;
+    this->state = s.state;
+    this->header_state = s.header_state;
+    this->index = s.index;
+    this->flags = s.flags;
+    this->m_status_code = s.status_code;
+    this->m_http_major = s.http_major;
+    this->m_http_minor = s.http_minor;
+    this->type = s.type;
+    this->m_method = s.method;
+    this->m_transfer_encoding = s.transfer_encoding;
+    this->m_http_errno = s.http_errno;
+    this->m_upgrade = s.upgrade;
+
+    return HPE_OK;
+}
+
+HTTP_PARSER_INLINE http_parser_pool::http_parser_pool(size_t slab_size)
+    : m_slab_size(slab_size ? slab_size : 1), m_free(nullptr)
+{
+}
+
+HTTP_PARSER_INLINE http_parser_pool::~http_parser_pool()
+{
+    for (size_t i = 0; i < m_slabs.size(); i++) {
+        ::operator delete(m_slabs[i]);
+    }
+}
+
+HTTP_PARSER_INLINE http_parser* http_parser_pool::acquire(http_parser::http_parser_type t)
+{
+    if (m_free == nullptr) {
+        node *slab = static_cast<node *>(::operator new(m_slab_size * sizeof(node)));
+        m_slabs.push_back(slab);
+
+        /* Thread the new slab onto the free list back to front, so parsers
+         * are handed out in address order.
+         */
+        for (size_t i = m_slab_size; i > 0; i--) {
+            slab[i - 1].next = m_free;
+            m_free = &slab[i - 1];
+        }
+    }
+
+    node *n = m_free;
+    m_free = n->next;
+    return new (n->storage) http_parser(t);
+}
+
+HTTP_PARSER_INLINE void http_parser_pool::release(http_parser *p)
+{
+    if (p == nullptr) {
+        return;
+    }
+
+    p->~http_parser();
+
+    /* LIFO: the next acquire() gets the parser that is most likely still
+     * in cache.
+     */
+    node *n = reinterpret_cast<node *>(p);
+    n->next = m_free;
+    m_free = n;
+}
+
+HTTP_PARSER_INLINE http_parser_pool& http_parser_pool::thread_local_pool()
+{
+    static thread_local http_parser_pool pool;
+    return pool;
+}
+
+HTTP_PARSER_INLINE http_header_arena::http_header_arena(size_t block_size)
+    : m_block_size(block_size ? block_size : 1)
+{
+    reset();
+}
+
+HTTP_PARSER_INLINE http_header_arena::http_header_arena(char *buf, size_t size, size_t block_size)
+    : m_block_size(block_size ? block_size : 1)
+{
+    block b = { buf, size, false };
+    m_blocks.push_back(b);
+    reset();
+}
+
+HTTP_PARSER_INLINE http_header_arena::~http_header_arena()
+{
+    for (size_t i = 0; i < m_blocks.size(); i++) {
+        if (m_blocks[i].owned) {
+            delete [] m_blocks[i].data;
+        }
+    }
+}
+
+HTTP_PARSER_INLINE void http_header_arena::reset()
+{
+    m_headers.clear();
+    m_current = 0;
+    m_used = 0;
+    m_str = nullptr;
+    m_str_len = 0;
+    m_last = NONE;
+}
+
+/* Append LENGTH bytes to the current string, moving it to a block with
+ * enough room if it no longer fits where it is.
+ */
+HTTP_PARSER_INLINE int http_header_arena::append(const char *at, size_t length)
+{
+    if (m_str == nullptr) {
+        m_str = m_current < m_blocks.size() ? m_blocks[m_current].data + m_used : nullptr;
+        m_str_len = 0;
+    }
+
+    if (m_current >= m_blocks.size() || m_used + length > m_blocks[m_current].size) {
+        size_t need = m_str_len + length;
+        size_t next = m_current < m_blocks.size() ? m_current + 1 : m_current;
+
+        /* blocks after the current one are free for reuse; take the next
+         * one if it is large enough, or put a new one in its place
+         */
+        if (next >= m_blocks.size() || m_blocks[next].size < need) {
+            size_t size = std::max(m_block_size, need);
+            block b = { new (std::nothrow) char[size], size, true };
+            if (b.data == nullptr) {
+                return -1;
+            }
+            m_blocks.insert(m_blocks.begin() + next, b);
+        }
+
+        if (m_str_len) {
+            memcpy(m_blocks[next].data, m_str, m_str_len);
+        }
+        m_current = next;
+        m_used = m_str_len;
+        m_str = m_blocks[next].data;
+    }
+
+    if (length) {
+        memcpy(m_blocks[m_current].data + m_used, at, length);
+    }
+    m_used += length;
+    m_str_len += length;
+    return 0;
+}
+
+HTTP_PARSER_INLINE int http_header_arena::append_field(const char *at, size_t length)
+{
+    if (m_last != FIELD) {
+        header h = { nullptr, 0, nullptr, 0 };
+        m_headers.push_back(h);
+        m_str = nullptr;
+        m_last = FIELD;
+    }
+
+    if (append(at, length) != 0) {
+        return -1;
+    }
+
+    m_headers.back().field = m_str;
+    m_headers.back().field_len = m_str_len;
+    return 0;
+}
+
+HTTP_PARSER_INLINE int http_header_arena::append_value(const char *at, size_t length)
+{
+    if (m_last == NONE) {
+        return -1;
+    }
+
+    if (m_last != VALUE) {
+        m_str = nullptr;
+        m_last = VALUE;
+    }
+
+    if (append(at, length) != 0) {
+        return -1;
+    }
+
+    m_headers.back().value = m_str;
+    m_headers.back().value_len = m_str_len;
+    return 0;
+}
+
+HTTP_PARSER_INLINE const http_header_arena::header* http_header_arena::find(const char *name) const
+{
+    size_t len = strlen(name);
+
+    for (size_t i = 0; i < m_headers.size(); i++) {
+        const header &h = m_headers[i];
+        if (h.field_len != len) {
+            continue;
+        }
+
+        size_t j = 0;
+        while (j < len && tolower((unsigned char) h.field[j]) == tolower((unsigned char) name[j])) {
+            j++;
+        }
+        if (j == len) {
+            return &h;
+        }
+    }
+
+    return nullptr;
+}
+
+HTTP_PARSER_INLINE void http_header_arena::bind(http_parser::parser_settings& settings)
+{
+    http_parser::http_cb on_begin = settings.on_message_begin;
+    http_parser::http_cb on_complete = settings.on_message_complete;
+
+    settings.on_header_field = [this](http_parser&, const char *at, size_t length) {
+        return append_field(at, length);
+    };
+    settings.on_header_value = [this](http_parser&, const char *at, size_t length) {
+        return append_value(at, length);
+    };
+    settings.on_message_begin = [this, on_begin](http_parser& p) {
+        reset();
+        return on_begin ? on_begin(p) : 0;
+    };
+    settings.on_message_complete = [this, on_complete](http_parser& p) {
+        int r = on_complete ? on_complete(p) : 0;
+        reset();
+        return r;
+    };
+}
+
+HTTP_PARSER_INLINE const char * http_parser::method_str (enum http_method m)
+{
+  return http_parser_detail::method_strings[m];
+}
+
+HTTP_PARSER_INLINE const char* http_parser::http_errno::name()
+{
+  using http_parser_detail::http_strerror_tab;
+  assert(m_errno < (sizeof(http_strerror_tab)/sizeof(http_strerror_tab[0])));
+  return http_strerror_tab[m_errno].name;
+}
+
+HTTP_PARSER_INLINE const char* http_parser::http_errno::description()
+{
+  using http_parser_detail::http_strerror_tab;
+  assert(m_errno < (sizeof(http_strerror_tab)/sizeof(http_strerror_tab[0])));
+  return http_strerror_tab[m_errno].description;
+}
+
+/* Keep the internal macros out of the including translation unit */
+#undef SET_ERRNO
+#undef RETURN
+#undef _CALLBACK_NOTIFY
+#undef CALLBACK_NOTIFY
+#undef CALLBACK_NOTIFY_NOADVANCE
+#undef _CALLBACK_DATA_AS
+#undef _CALLBACK_DATA
+#undef CALLBACK_DATA
+#undef CALLBACK_DATA_NOADVANCE
+#undef CALLBACK_SPACE
+#undef IS_TRAILER_CB
+#undef _CALLBACK_HEADER
+#undef CALLBACK_HEADER
+#undef CALLBACK_HEADER_NOADVANCE
+#undef CALLBACK_HEADER_SPACE
+#undef CALLBACK_DECHUNKED
+#undef CALLBACK_CHUNK_NOTIFY
+#undef MARK
+#undef CONTENT_LENGTH
+#undef TRANSFER_ENCODING
+#undef UPGRADE
+#undef CHUNKED
+#undef GZIP
+#undef DEFLATE
+#undef BR
+#undef IDENTITY
+#undef SPACE
+#undef STATE_ATTRIBUTES
+#undef PARSING_HEADER
+#undef PARSING_CHUNK_LINE
+#undef CR
+#undef LF
+#undef QT
+#undef BS
+#undef LOWER
+#undef TOKEN
+#undef IS_ALPHA
+#undef IS_NUM
+#undef IS_ALPHANUM
+#undef IS_HEX
+#undef IS_MARK
+#undef IS_USERINFO_CHAR
+#undef CHAR_CLASS
+#undef IS_URL_CHAR
+#undef IS_HOST_CHAR
+#undef start_state
+#undef PARSER_TYPE
+#undef STATE
+#undef NEXT_BYTE
+#undef BOTH_STATE
+#undef REQUEST_STATE
+#undef RESPONSE_STATE
+#undef STATE_LABELS
+#undef STRICT_CHECK
+#undef CHECK_CHUNK_LINE_SIZE
+#undef NEW_MESSAGE
+#undef MOVE_THE_HEAD
+#undef MOVE_FAST
@@ -0,0 +1,154 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Training run for profile-guided builds (see "make pgo"). Every FILE is
+ * one connection: raw HTTP requests and/or responses back to back, parsed
+ * as HTTP_BOTH and followed by EOF. Each of the ITERATIONS rounds (100 by
+ * default) parses every file in one buffer and again split into reads of
+ * 1, 7, 64, 536 and 1460 bytes and of pseudo-random sizes, so that the
+ * profile covers pipelined input as well as messages cut at any byte.
+ * The random splits use a fixed seed, so a run is reproducible.
+ *
+ *   ./pgo_train [-n iterations] file...
+ *
+ * Exits non-zero if a file does not parse. The throughput it prints makes
+ * the same run usable to compare builds.
+ */
+
+#include "http_parser.hpp"
+#include "test_helpers.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+static const size_t read_sizes[] = { 0, 1, 7, 64, 536, 1460 };
+
+static unsigned long messages;
+
+static int on_message_complete(http_parser&) {
+  messages++;
+  return 0;
+}
+
+/* Parse BUF as one connection in reads of READ_SIZE bytes (the whole
+ * buffer if 0, random sizes up to 2048 if -1).
+ */
+static bool parse(const http_parser::parser_settings& settings,
+                  http_parser& parser, const std::string& buf,
+                  long read_size, uint32_t& seed) {
+  const char *data = buf.data();
+  size_t left = buf.size();
+  size_t len, nparsed;
+
+  parser.reset(http_parser::HTTP_BOTH);
+
+  while (left > 0) {
+    if (read_size == 0) {
+      len = left;
+    } else if (read_size < 0) {
+      len = test_helpers::next_random(seed) % 2048 + 1;
+    } else {
+      len = read_size;
+    }
+    if (len > left) {
+      len = left;
+    }
+
+    nparsed = parser.execute(settings, data, len);
+    if (nparsed != len) {
+      return false;
+    }
+
+    data += len;
+    left -= len;
+  }
+
+  parser.execute(settings, NULL, 0);
+  return strcmp(parser.get_errno().name(), "HPE_OK") == 0;
+}
+
+int main(int argc, char **argv) {
+  unsigned long iterations = 100;
+  unsigned long i;
+  unsigned long long bytes = 0;
+  uint32_t seed = 2463534242u;
+  std::vector<std::string> files;
+  int first = 1;
+  int f;
+  size_t s;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    iterations = strtoul(argv[2], NULL, 10);
+    first = 3;
+  }
+
+  if (first >= argc) {
+    fprintf(stderr, "usage: %s [-n iterations] file...\n", argv[0]);
+    return 1;
+  }
+
+  for (f = first; f < argc; f++) {
+    files.emplace_back();
+    if (!test_helpers::load(argv[f], files.back())) {
+      return 1;
+    }
+  }
+
+  http_parser::parser_settings settings = test_helpers::null_settings();
+  settings.on_message_complete = on_message_complete;
+
+  http_parser parser(http_parser::HTTP_BOTH);
+  struct timespec start, end;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (i = 0; i < iterations; i++) {
+    for (f = 0; f < (int) files.size(); f++) {
+      for (s = 0; s <= sizeof(read_sizes) / sizeof(read_sizes[0]); s++) {
+        long read_size = s < sizeof(read_sizes) / sizeof(read_sizes[0])
+                       ? (long) read_sizes[s] : -1;
+
+        if (!parse(settings, parser, files[f], read_size, seed)) {
+          fprintf(stderr, "%s: %s (%s)\n", argv[first + f],
+                  parser.get_errno().description(),
+                  parser.get_errno().name());
+          return 1;
+        }
+        bytes += files[f].size();
+      }
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+  printf("%lu files, %lu iterations\n", (unsigned long) files.size(), iterations);
+  printf("%llu bytes, %lu messages in %.3f s\n", bytes, messages, secs);
+  printf("%.2f MB/s, %.0f ns/message\n",
+         bytes / secs / (1024 * 1024), secs * 1e9 / messages);
+
+  return 0;
+}
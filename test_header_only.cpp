@@ -0,0 +1,191 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* The header-only build (HTTP_PARSER_HEADER_ONLY=1) with settings whose
+ * callbacks are static member functions. This file is linked with
+ * test_helpers.cpp, also compiled header-only, so that a definition of
+ * http_parser.ipp that is not inline shows up as a duplicate symbol.
+ *
+ * Every message is parsed with static_settings and with the std::function
+ * settings of test_helpers::tracing_settings(), which must give the same
+ * trace, and a body is skipped with consume_body<static_settings>().
+ *
+ *   ./test_header_only
+ */
+
+#include "http_parser.hpp"
+#include "test_helpers.hpp"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#if !HTTP_PARSER_HEADER_ONLY
+# error "compile with -DHTTP_PARSER_HEADER_ONLY=1"
+#endif
+
+static test_helpers::trace tracer;
+
+/* Makes on_headers_complete ask for the body to be bypassed */
+static bool bypass;
+
+/* The callbacks of tracing_settings() as static member functions, except
+ * for on_chunk_extension, which is a null function pointer, so chunk
+ * extensions are skipped.
+ */
+struct static_settings {
+  static int on_message_begin(http_parser&) {
+    return tracer.notify("begin");
+  }
+  static int on_url(http_parser&, const char *at, size_t length) {
+    return tracer.record("url:", at, length);
+  }
+  static int on_reason(http_parser&, const char *at, size_t length) {
+    return tracer.record("reason:", at, length);
+  }
+  static int on_header_field(http_parser&, const char *at, size_t length) {
+    return tracer.record("field:", at, length);
+  }
+  static int on_header_value(http_parser&, const char *at, size_t length) {
+    return tracer.record("value:", at, length);
+  }
+  static int on_headers_complete(http_parser& p, const char *, size_t) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "headers %u %u HTTP/%u.%u te=%u cl=%lld",
+             p.request_method(), p.status_code(), p.http_major(), p.http_minor(),
+             p.transfer_encoding(), (long long) p.content_length());
+    tracer.notify(buf);
+    return bypass ? 2 : 0;
+  }
+  static int on_body(http_parser&, const char *at, size_t length) {
+    return tracer.record("body:", at, length);
+  }
+  static int on_message_complete(http_parser& p) {
+    tracer.upgraded = p.has_upgrade();
+    return tracer.notify("complete");
+  }
+  static int on_chunk_header(http_parser& p) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "chunk %lld", (long long) p.content_length());
+    return tracer.notify(buf);
+  }
+  static int on_chunk_complete(http_parser&) {
+    return tracer.notify("chunk done");
+  }
+  static constexpr int (*on_chunk_extension)(http_parser&, const char *, size_t) = nullptr;
+  static int on_trailer_field(http_parser&, const char *at, size_t length) {
+    return tracer.record("trailer field:", at, length);
+  }
+  static int on_trailer_value(http_parser&, const char *at, size_t length) {
+    return tracer.record("trailer value:", at, length);
+  }
+  static int on_trailers_complete(http_parser&) {
+    return tracer.notify("trailers done");
+  }
+};
+
+template <class Settings>
+static std::string parse(const Settings& settings, http_parser::http_parser_type type,
+                         const char *buf) {
+  size_t len = strlen(buf);
+  http_parser p(type);
+
+  tracer.clear();
+  if (p.execute<http_parser_default_policy>(settings, buf, len) == len) {
+    p.execute<http_parser_default_policy>(settings, NULL, 0);
+  }
+  return tracer.out + "\nend " + p.get_errno().name();
+}
+
+static int test_same_trace(http_parser::http_parser_type type, const char *buf) {
+  http_parser::parser_settings function_settings = test_helpers::tracing_settings(tracer);
+  std::string expected, actual;
+
+  function_settings.on_chunk_extension = nullptr;
+  expected = parse(function_settings, type, buf);
+  actual = parse(static_settings(), type, buf);
+  if (actual != expected) {
+    fprintf(stderr, "static settings differ\n--- expected:%s\n--- actual:%s\n",
+            expected.c_str(), actual.c_str());
+    return 1;
+  }
+  return 0;
+}
+
+static void test_consume_body() {
+  const char *req = "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\n";
+  size_t len = strlen(req), nparsed;
+  int err;
+
+  http_parser p(http_parser::HTTP_REQUEST);
+  tracer.clear();
+  bypass = true;
+  nparsed = p.execute<http_parser_default_policy>(static_settings(), req, len);
+  bypass = false;
+  assert(nparsed == len);
+  assert(p.bypass_length() == 10);
+
+  err = p.consume_body(static_settings(), 11);
+  assert(err == HPE_INVALID_INTERNAL_STATE);
+  err = p.consume_body(static_settings(), 10);
+  assert(err == HPE_OK);
+  assert(p.bypass_length() == 0);
+  assert(tracer.out == "\nbegin"
+                       "\nurl:/"
+                       "\nfield:Content-Length"
+                       "\nvalue:10"
+                       "\nheaders 3 0 HTTP/1.1 te=0 cl=10"
+                       "\ncomplete");
+}
+
+int main() {
+  int failed = 0;
+
+  failed |= test_same_trace(http_parser::HTTP_REQUEST,
+                            "GET /a?b#c HTTP/1.1\r\n"
+                            "Host: example.com\r\n"
+                            "\r\n"
+                            "POST /upload HTTP/1.1\r\n"
+                            "Content-Length: 5\r\n"
+                            "\r\n"
+                            "hello");
+  failed |= test_same_trace(http_parser::HTTP_RESPONSE,
+                            "HTTP/1.1 200 OK\r\n"
+                            "Transfer-Encoding: chunked\r\n"
+                            "\r\n"
+                            "5;ext=1\r\nhello\r\n"
+                            "0\r\n"
+                            "X-Trailer: 1\r\n"
+                            "\r\n");
+  failed |= test_same_trace(http_parser::HTTP_RESPONSE,
+                            "HTTP/1.0 200 OK\r\n"
+                            "\r\n"
+                            "until EOF");
+  if (failed) {
+    return 1;
+  }
+
+  test_consume_body();
+
+  printf("header-only OK\n");
+  return 0;
+}
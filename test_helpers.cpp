@@ -0,0 +1,150 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "test_helpers.hpp"
+#include <stdio.h>
+#include <string.h>
+
+namespace test_helpers {
+
+void trace::clear() {
+  out.clear();
+  last_event = NULL;
+  upgraded = false;
+}
+
+int trace::record(const char *event, const char *at, size_t length) {
+  size_t i;
+
+  if (last_event == NULL || strcmp(last_event, event) != 0) {
+    out.append("\n");
+    out.append(event);
+    last_event = event;
+  }
+  for (i = 0; i < length; i++) {
+    switch (at[i]) {
+    case '\n': out.append("\\n"); break;
+    case '\r': out.append("\\r"); break;
+    case '\\': out.append("\\\\"); break;
+    default: out.push_back(at[i]); break;
+    }
+  }
+  return 0;
+}
+
+int trace::notify(const char *event) {
+  out.append("\n");
+  out.append(event);
+  last_event = NULL;
+  return 0;
+}
+
+http_parser::parser_settings tracing_settings(trace& t) {
+  http_parser::parser_settings s;
+
+  s.on_message_begin = [&t](http_parser&) { return t.notify("begin"); };
+  s.on_url = [&t](http_parser&, const char *at, size_t length) {
+    return t.record("url:", at, length);
+  };
+  s.on_reason = [&t](http_parser&, const char *at, size_t length) {
+    return t.record("reason:", at, length);
+  };
+  s.on_header_field = [&t](http_parser&, const char *at, size_t length) {
+    return t.record("field:", at, length);
+  };
+  s.on_header_value = [&t](http_parser&, const char *at, size_t length) {
+    return t.record("value:", at, length);
+  };
+  s.on_headers_complete = [&t](http_parser& p, const char *, size_t) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "headers %u %u HTTP/%u.%u te=%u cl=%lld",
+             p.request_method(), p.status_code(), p.http_major(), p.http_minor(),
+             p.transfer_encoding(), (long long) p.content_length());
+    return t.notify(buf);
+  };
+  s.on_body = [&t](http_parser&, const char *at, size_t length) {
+    return t.record("body:", at, length);
+  };
+  s.on_message_complete = [&t](http_parser& p) {
+    t.upgraded = p.has_upgrade();
+    return t.notify("complete");
+  };
+  s.on_chunk_header = [&t](http_parser& p) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "chunk %lld", (long long) p.content_length());
+    return t.notify(buf);
+  };
+  s.on_chunk_complete = [&t](http_parser&) { return t.notify("chunk done"); };
+  s.on_chunk_extension = [&t](http_parser&, const char *at, size_t length) {
+    return t.record("ext:", at, length);
+  };
+  s.on_trailer_field = [&t](http_parser&, const char *at, size_t length) {
+    return t.record("trailer field:", at, length);
+  };
+  s.on_trailer_value = [&t](http_parser&, const char *at, size_t length) {
+    return t.record("trailer value:", at, length);
+  };
+  s.on_trailers_complete = [&t](http_parser&) { return t.notify("trailers done"); };
+
+  return s;
+}
+
+http_parser::parser_settings null_settings() {
+  http_parser::parser_settings s;
+  auto info = [](http_parser&) { return 0; };
+  auto data = [](http_parser&, const char *, size_t) { return 0; };
+
+  s.on_message_begin = info;
+  s.on_url = data;
+  s.on_reason = data;
+  s.on_header_field = data;
+  s.on_header_value = data;
+  s.on_headers_complete = data;
+  s.on_body = data;
+  s.on_message_complete = info;
+  s.on_chunk_header = info;
+  s.on_chunk_complete = info;
+  s.on_chunk_extension = data;
+  s.on_trailer_field = data;
+  s.on_trailer_value = data;
+  s.on_trailers_complete = info;
+
+  return s;
+}
+
+bool load(const char *name, std::string& buf) {
+  FILE *f = fopen(name, "rb");
+  char chunk[65536];
+  size_t n;
+
+  if (f == NULL) {
+    perror(name);
+    return false;
+  }
+
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+    buf.append(chunk, n);
+  }
+
+  fclose(f);
+  return true;
+}
+
+}  // namespace test_helpers
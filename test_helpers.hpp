@@ -0,0 +1,74 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Helpers shared by the tests, the fuzzer and the training and benchmark
+ * programs: a textual trace of the callbacks of execute(), settings that
+ * do nothing, reading a file and a reproducible random number generator.
+ */
+
+#pragma once
+
+#include "http_parser.hpp"
+#include <stdint.h>
+
+#include <string>
+
+namespace test_helpers {
+
+/* The callbacks of execute(), one event per line. Data callbacks are
+ * "name:data", with consecutive calls of the same one merged, since they
+ * may be split wherever the input is, and CR, LF and backslash escaped;
+ * the others are a line of their own. Two parses that ran the same
+ * callbacks with the same data have the same trace.
+ */
+struct trace {
+  std::string out;
+  const char *last_event = NULL;
+  /* on_message_complete saw has_upgrade(); the body of the upgrading
+   * message, if it has one, comes before
+   */
+  bool upgraded = false;
+
+  void clear();
+  int record(const char *event, const char *at, size_t length);
+  int notify(const char *event);
+};
+
+/* Settings with every callback set, tracing into T */
+http_parser::parser_settings tracing_settings(trace& t);
+
+/* Settings with every callback set to one that does nothing */
+http_parser::parser_settings null_settings();
+
+/* Appends the contents of file NAME to BUF; prints why and returns false
+ * if it cannot be read.
+ */
+bool load(const char *name, std::string& buf);
+
+/* xorshift32, so that a run is reproducible */
+inline uint32_t next_random(uint32_t& x) {
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+}  // namespace test_helpers
@@ -0,0 +1,279 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* export_state()/import_state() round trips: every message of corpus.hpp,
+ * and the keep-alive ones of each type pipelined into one stream, is
+ * parsed once in one buffer, then again split at every byte offset with
+ * the first part parsed by one parser and the rest by another that
+ * imported its state through a byte copy of the exported blob. The
+ * callbacks of both runs must be identical.
+ *
+ * import_state() must refuse a state with any field out of range or
+ * inconsistent with the others, and a state with a random byte changed
+ * that it does take must not trip the assertions of execute().
+ *
+ *   ./test_state
+ */
+
+#include "http_parser.hpp"
+#include "corpus.hpp"
+#include "test_helpers.hpp"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+static test_helpers::trace tracer;
+
+static void finish(const http_parser::parser_settings& settings,
+                   http_parser& parser, std::string& out) {
+  char buf[64];
+
+  parser.execute(settings, NULL, 0);
+  snprintf(buf, sizeof(buf), "\nend %s", parser.get_errno().name());
+  out.append(buf);
+}
+
+static int test_round_trip(const char *name, http_parser::http_parser_type type,
+                           const std::string& buf) {
+  http_parser::parser_settings settings = test_helpers::tracing_settings(tracer);
+  std::string expected, actual;
+  size_t split, nparsed, len;
+  int err;
+
+  tracer.clear();
+  http_parser whole(type);
+  /* less than all of it if the connection is upgraded */
+  len = whole.execute(settings, buf.data(), buf.size());
+  assert(len == buf.size() || whole.has_upgrade());
+  finish(settings, whole, tracer.out);
+  expected = tracer.out;
+
+  for (split = 0; split <= len; split++) {
+    tracer.clear();
+
+    http_parser before(type);
+    if (split > 0) {
+      nparsed = before.execute(settings, buf.data(), split);
+      assert(nparsed == split);
+    }
+
+    http_parser::exported_state state, again;
+    unsigned char blob[sizeof(state)];
+    before.export_state(state);
+    memcpy(blob, &state, sizeof(blob));
+    memset(&state, 0xff, sizeof(state));
+    memcpy(&state, blob, sizeof(blob));
+
+    /* constructed for another type; the import must override it */
+    http_parser after(type == http_parser::HTTP_REQUEST ?
+                      http_parser::HTTP_RESPONSE : http_parser::HTTP_REQUEST);
+    err = after.import_state(state);
+    assert(err == HPE_OK);
+    after.export_state(again);
+    assert(memcmp(&again, blob, sizeof(blob)) == 0);
+
+    /* an empty buffer would already mean EOF */
+    if (split < len) {
+      nparsed = after.execute(settings, buf.data() + split, buf.size() - split);
+      assert(nparsed == len - split);
+    }
+    finish(settings, after, tracer.out);
+    actual = tracer.out;
+
+    if (actual != expected) {
+      fprintf(stderr, "%s: callbacks differ when migrated at offset %lu\n"
+              "expected:%s\n\nactual:%s\n", name, (unsigned long) split,
+              expected.c_str(), actual.c_str());
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/* The messages of MSGS that leave the connection open, one after the other */
+static std::string pipelined(const corpus::message *msgs, int n) {
+  std::string s;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    if (msgs[i].should_keep_alive && !msgs[i].message_complete_on_eof &&
+        msgs[i].upgrade == NULL) {
+      s += msgs[i].raw;
+    }
+  }
+  return s;
+}
+
+/* PARSER, in a state that BAD is a copy of with one field changed, must
+ * refuse it and stay as it was
+ */
+static void expect_refused(http_parser& parser, const http_parser::exported_state& bad) {
+  http_parser::exported_state before, after;
+  int err;
+
+  parser.export_state(before);
+  err = parser.import_state(bad);
+  parser.export_state(after);
+  assert(err == HPE_INVALID_INTERNAL_STATE);
+  assert(memcmp(&before, &after, sizeof(before)) == 0);
+}
+
+/* State of a parser of TYPE after DATA */
+static http_parser::exported_state state_after(http_parser::http_parser_type type,
+                                               const char *data) {
+  http_parser parser(type);
+  http_parser::exported_state state;
+  size_t nparsed;
+
+  nparsed = parser.execute(test_helpers::null_settings(), data, strlen(data));
+  assert(nparsed == strlen(data));
+  assert(strcmp(parser.get_errno().name(), "HPE_OK") == 0);
+  parser.export_state(state);
+  return state;
+}
+
+static void test_import_invalid(void) {
+  http_parser parser(http_parser::HTTP_REQUEST);
+  http_parser::exported_state state, bad;
+  int err;
+
+  state = state_after(http_parser::HTTP_REQUEST, "GET / HTTP/1.1\r\nHo");
+  err = parser.import_state(state);
+  assert(err == HPE_OK);
+
+  bad = state; bad.version++; expect_refused(parser, bad);
+  bad = state; bad.reserved = 1; expect_refused(parser, bad);
+  bad = state; bad.nread = HTTP_MAX_HEADER_SIZE + 1; expect_refused(parser, bad);
+  bad = state; bad.content_length = -2; expect_refused(parser, bad);
+  bad = state; bad.status_code = 1000; expect_refused(parser, bad);
+  bad = state; bad.http_major = 1000; expect_refused(parser, bad);
+  bad = state; bad.http_minor = 1000; expect_refused(parser, bad);
+  bad = state; bad.state = 0; expect_refused(parser, bad);
+  bad = state; bad.state = 0xff; expect_refused(parser, bad);
+  bad = state; bad.header_state = 0xff; expect_refused(parser, bad);
+  bad = state; bad.flags = 0x80; expect_refused(parser, bad);
+  bad = state; bad.type = 3; expect_refused(parser, bad);
+  bad = state; bad.method = http_parser::HTTP_PATCH + 1; expect_refused(parser, bad);
+  bad = state; bad.transfer_encoding = 0x80; expect_refused(parser, bad);
+  bad = state; bad.http_errno = 0x7f; expect_refused(parser, bad);
+  bad = state; bad.upgrade = 2; expect_refused(parser, bad);
+
+  /* the method is matched against method_strings[method][index] */
+  state = state_after(http_parser::HTTP_REQUEST, "GE");
+  err = parser.import_state(state);
+  assert(err == HPE_OK);
+  bad = state; bad.index = 4; expect_refused(parser, bad);
+
+  /* and the transfer coding against te_codings[] */
+  state = state_after(http_parser::HTTP_REQUEST,
+                      "GET / HTTP/1.1\r\nTransfer-Encoding: chun");
+  err = parser.import_state(state);
+  assert(err == HPE_OK);
+  bad = state; bad.index = 7; expect_refused(parser, bad);
+
+  /* a body needs bytes left to read */
+  state = state_after(http_parser::HTTP_REQUEST,
+                      "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\nab");
+  err = parser.import_state(state);
+  assert(err == HPE_OK);
+  bad = state; bad.content_length = 0; expect_refused(parser, bad);
+  bad = state; bad.content_length = -1; expect_refused(parser, bad);
+
+  /* and a chunk a chunked message */
+  state = state_after(http_parser::HTTP_RESPONSE,
+                      "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nab");
+  err = parser.import_state(state);
+  assert(err == HPE_OK);
+  bad = state; bad.flags &= ~http_parser::F_CHUNKED; expect_refused(parser, bad);
+  bad = state; bad.content_length = 0; expect_refused(parser, bad);
+}
+
+/* States exported at every offset of BUF with one random byte changed:
+ * whichever import_state() takes, execute() must go on from without
+ * failing an assertion
+ */
+static void test_import_mutated(http_parser::http_parser_type type, const std::string& buf,
+                                uint32_t& seed) {
+  http_parser::parser_settings settings = test_helpers::null_settings();
+  http_parser::exported_state state;
+  unsigned char *bytes = (unsigned char *) &state;
+  size_t split, nparsed;
+  int i, err;
+
+  for (split = 0; split < buf.size(); split++) {
+    http_parser before(type);
+    if (split > 0) {
+      nparsed = before.execute(settings, buf.data(), split);
+      if (nparsed != split) {
+        return;
+      }
+    }
+
+    for (i = 0; i < 8; i++) {
+      before.export_state(state);
+      bytes[test_helpers::next_random(seed) % sizeof(state)] ^=
+        1 + test_helpers::next_random(seed) % 255;
+
+      http_parser after(type);
+      err = after.import_state(state);
+      if (err == HPE_OK) {
+        after.execute(settings, buf.data() + split, buf.size() - split);
+        after.execute(settings, NULL, 0);
+      }
+    }
+  }
+}
+
+int main(void) {
+  std::string requests = pipelined(corpus::requests, corpus::NUM_REQUESTS);
+  std::string responses = pipelined(corpus::responses, corpus::NUM_RESPONSES);
+  uint32_t seed = 1;
+  int i;
+
+  test_import_invalid();
+
+  for (i = 0; i < corpus::NUM_REQUESTS; i++) {
+    if (test_round_trip(corpus::requests[i].name, http_parser::HTTP_REQUEST,
+                        corpus::requests[i].raw) != 0) {
+      return 1;
+    }
+  }
+  for (i = 0; i < corpus::NUM_RESPONSES; i++) {
+    if (test_round_trip(corpus::responses[i].name, http_parser::HTTP_RESPONSE,
+                        corpus::responses[i].raw) != 0) {
+      return 1;
+    }
+  }
+  if (test_round_trip("pipelined requests", http_parser::HTTP_REQUEST, requests) != 0 ||
+      test_round_trip("pipelined responses", http_parser::HTTP_RESPONSE, responses) != 0) {
+    return 1;
+  }
+
+  test_import_mutated(http_parser::HTTP_REQUEST, requests, seed);
+  test_import_mutated(http_parser::HTTP_RESPONSE, responses, seed);
+
+  printf("state round trips OK\n");
+  return 0;
+}